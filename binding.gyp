@@ -1,31 +1,80 @@
 {
+  'variables': {
+    # The signature code is built once per field representation, and the
+    # fastest copy the CPU supports is picked when the module loads. Set
+    # ED25519_BACKEND to force one (see src/ed25519/dispatch.c).
+    # 'ref10': ten 32-bit limbs, portable.
+    # 'fe51': five 64-bit limbs, needs unsigned __int128.
+    # 'fe64': four 64-bit limbs, MULX/ADCX/ADOX kernels on BMI2 and ADX CPUs.
+    # Override with: node-gyp rebuild -- -Ded25519_fields="ref10 fe51"
+    # Field inversion, for every backend (see src/ed25519/fe_invert.c):
+    # 'safegcd': constant-time divsteps, needs __int128.
+    # 'pow': the ref10 exponentiation chain.
+    # Override with: node-gyp rebuild -- -Ded25519_invert=pow
+    'conditions': [
+      ['OS!="win" and target_arch=="x64"', {
+        'ed25519_fields%': 'ref10 fe51 fe64',
+        'ed25519_invert%': 'safegcd'
+      }, 'OS!="win" and target_arch in "arm64 ppc64 s390x"', {
+        'ed25519_fields%': 'ref10 fe51',
+        'ed25519_invert%': 'safegcd'
+      }, {
+        'ed25519_fields%': 'ref10',
+        'ed25519_invert%': 'pow'
+      }]
+    ],
+    'ed25519_backend_sources': [
+      'src/ed25519/keypair.c',
+      'src/ed25519/keypair_batch.c',
+      'src/ed25519/sign.c',
+      'src/ed25519/sign_batch.c',
+      'src/ed25519/signer.c',
+      'src/ed25519/open.c',
+      'src/ed25519/batch.c',
+      'src/ed25519/verifying_key.c',
+      'src/ed25519/verifier.c',
+      'src/ed25519/backend.c',
+      'src/ed25519/ge_double_scalarmult.c',
+      'src/ed25519/ge_multi_scalarmult.c',
+      'src/ed25519/ge_frombytes.c',
+      'src/ed25519/ge_scalarmult_base.c',
+      'src/ed25519/ge_scalarmult_base_x4.c',
+      'src/ed25519/ge_precomp_0.c',
+      'src/ed25519/ge_precomp_odd_multiples.c',
+      'src/ed25519/ge_p2_0.c',
+      'src/ed25519/ge_p2_dbl.c',
+      'src/ed25519/ge_p3_0.c',
+      'src/ed25519/ge_p3_dbl.c',
+      'src/ed25519/ge_p3_to_p2.c',
+      'src/ed25519/ge_p3_to_cached.c',
+      'src/ed25519/ge_p3_tobytes.c',
+      'src/ed25519/ge_p3_batch_tobytes.c',
+      'src/ed25519/ge_madd.c',
+      'src/ed25519/ge_add.c',
+      'src/ed25519/ge_msub.c',
+      'src/ed25519/ge_sub.c',
+      'src/ed25519/ge_p1p1_to_p3.c',
+      'src/ed25519/ge_p1p1_to_p2.c',
+      'src/ed25519/ge_tobytes.c',
+      'src/ed25519/fe_invert.c',
+      'src/ed25519/fe_isnegative.c',
+      'src/ed25519/fe_isnonzero.c',
+      'src/ed25519/fe_pow22523.c'
+    ]
+  },
+  'target_defaults': {
+    'conditions': [
+      ['ed25519_invert=="safegcd"', {
+        'defines': ['ED25519_SAFEGCD']
+      }]
+    ]
+  },
   'targets': [
     {
-      'target_name': 'ed25519',
+      'target_name': 'ed25519_ref10',
+      'type': 'static_library',
       'sources': [
-        'src/sha512.c',
-        'src/ed25519/keypair.c',
-        'src/ed25519/sign.c',
-        'src/ed25519/open.c',
-        'src/ed25519/crypto_verify_32.c',
-        'src/ed25519/ge_double_scalarmult.c',
-        'src/ed25519/ge_frombytes.c',
-        'src/ed25519/ge_scalarmult_base.c',
-        'src/ed25519/ge_precomp_0.c',
-        'src/ed25519/ge_p2_0.c',
-        'src/ed25519/ge_p2_dbl.c',
-        'src/ed25519/ge_p3_0.c',
-        'src/ed25519/ge_p3_dbl.c',
-        'src/ed25519/ge_p3_to_p2.c',
-        'src/ed25519/ge_p3_to_cached.c',
-        'src/ed25519/ge_p3_tobytes.c',
-        'src/ed25519/ge_madd.c',
-        'src/ed25519/ge_add.c',
-        'src/ed25519/ge_msub.c',
-        'src/ed25519/ge_sub.c',
-        'src/ed25519/ge_p1p1_to_p3.c',
-        'src/ed25519/ge_p1p1_to_p2.c',
-        'src/ed25519/ge_tobytes.c',
+        '<@(ed25519_backend_sources)',
         'src/ed25519/fe_0.c',
         'src/ed25519/fe_1.c',
         'src/ed25519/fe_cmov.c',
@@ -36,19 +85,89 @@
         'src/ed25519/fe_mul.c',
         'src/ed25519/fe_sq.c',
         'src/ed25519/fe_sq2.c',
-        'src/ed25519/fe_invert.c',
         'src/ed25519/fe_tobytes.c',
-        'src/ed25519/fe_isnegative.c',
-        'src/ed25519/fe_isnonzero.c',
-        'src/ed25519/fe_frombytes.c',
-        'src/ed25519/fe_pow22523.c',
+        'src/ed25519/fe_frombytes.c'
+      ]
+    },
+    {
+      'target_name': 'ed25519',
+      'dependencies': ['ed25519_ref10'],
+      'sources': [
+        'src/sha512.c',
+        'src/ed25519/cpu.c',
+        'src/ed25519/dispatch.c',
+        'src/ed25519/crypto_verify_32.c',
         'src/ed25519/sc_reduce.c',
         'src/ed25519/sc_muladd.c',
+        'src/pool.cc',
         'src/ed25519.cc'
       ],
+      'conditions': [
+        ['"fe51" in ed25519_fields', {
+          'defines': ['ED25519_HAVE_FE51'],
+          'dependencies': ['ed25519_fe51']
+        }],
+        ['"fe64" in ed25519_fields', {
+          'defines': ['ED25519_HAVE_FE64'],
+          'dependencies': ['ed25519_fe64']
+        }],
+        ['ed25519_invert=="safegcd"', {
+          'sources': ['src/ed25519/safegcd.c']
+        }]
+      ],
       'include_dirs': [
         "<!(node -e \"require('nan')\")"
       ]
     }
+  ],
+  'conditions': [
+    ['"fe51" in ed25519_fields', {
+      'targets': [
+        {
+          'target_name': 'ed25519_fe51',
+          'type': 'static_library',
+          'defines': ['ED25519_FE51'],
+          'sources': [
+            '<@(ed25519_backend_sources)',
+            'src/ed25519/fe51/fe_0.c',
+            'src/ed25519/fe51/fe_1.c',
+            'src/ed25519/fe51/fe_cmov.c',
+            'src/ed25519/fe51/fe_copy.c',
+            'src/ed25519/fe51/fe_neg.c',
+            'src/ed25519/fe51/fe_add.c',
+            'src/ed25519/fe51/fe_sub.c',
+            'src/ed25519/fe51/fe_mul.c',
+            'src/ed25519/fe51/fe_sq.c',
+            'src/ed25519/fe51/fe_sq2.c',
+            'src/ed25519/fe51/fe_tobytes.c',
+            'src/ed25519/fe51/fe_frombytes.c'
+          ]
+        }
+      ]
+    }],
+    ['"fe64" in ed25519_fields', {
+      'targets': [
+        {
+          'target_name': 'ed25519_fe64',
+          'type': 'static_library',
+          'defines': ['ED25519_FE64'],
+          'sources': [
+            '<@(ed25519_backend_sources)',
+            'src/ed25519/fe64/fe_0.c',
+            'src/ed25519/fe64/fe_1.c',
+            'src/ed25519/fe64/fe_cmov.c',
+            'src/ed25519/fe64/fe_copy.c',
+            'src/ed25519/fe64/fe_neg.c',
+            'src/ed25519/fe64/fe_add.c',
+            'src/ed25519/fe64/fe_sub.c',
+            'src/ed25519/fe64/fe_mul.c',
+            'src/ed25519/fe64/fe_sq.c',
+            'src/ed25519/fe64/fe_sq2.c',
+            'src/ed25519/fe64/fe_tobytes.c',
+            'src/ed25519/fe64/fe_frombytes.c'
+          ]
+        }
+      ]
+    }]
   ]
 }
@@ -48,6 +48,14 @@ if (ed25519.Verify(Buffer.from(message, 'utf8'), signature3, aliceKeypair.public
 	console.log('Signature3 NOT valid');
 }
 
+// All three functions have *Async versions that run on the libuv threadpool instead of blocking the event loop.
+// They take a node style callback as the last argument, or return a Promise when it is left out.
+ed25519.SignAsync(Buffer.from(message, 'utf8'), aliceKeypair).then(function (signature4) {
+	return ed25519.VerifyAsync(Buffer.from(message, 'utf8'), signature4, aliceKeypair.publicKey);
+}).then(function (valid) {
+	console.log(valid ? 'Signature4 valid' : 'Signature4 NOT valid');
+});
+
 // Alice is a very courious gal and notices that there is also a key_exchange.c in the public domain code
 // that Dave used from https://github.com/nightcracker/ed25519 and wonders if Dave will add a key exchange
 // function to this module.
@@ -1 +1,286 @@
-module.exports = require('bindings')('ed25519');
+var fs = require('fs');
+var ed25519 = module.exports = require('bindings')('ed25519');
+
+/*
+  The native *Async functions take a node style callback as their last
+  argument. When the caller leaves it out, return a Promise instead.
+  Arguments from position required on are optional: a function there is
+  taken as the callback.
+*/
+function withPromise(fn, arity, required) {
+  if (required === undefined) {
+    required = arity;
+  }
+  return function () {
+    var count = Math.min(arguments.length, arity + 1);
+    var callback = arguments[count - 1];
+    var args;
+    if (typeof callback === 'function' && count > required) {
+      args = Array.prototype.slice.call(arguments, 0, count - 1);
+    } else {
+      args = Array.prototype.slice.call(arguments, 0, arity);
+      args.length = arity;
+      callback = undefined;
+    }
+    if (callback) {
+      args.push(callback);
+      return fn.apply(null, args);
+    }
+    return new Promise(function (resolve, reject) {
+      args.push(function (err, result) {
+        if (err) {
+          reject(err);
+        } else {
+          resolve(result);
+        }
+      });
+      fn.apply(null, args);
+    });
+  };
+}
+
+/*
+  Lets the native *BatchAsync functions take options.signal, an
+  AbortSignal: when it fires, the chunks of the job that have not started
+  yet are skipped. options sits at index position, before the callback.
+*/
+function withSignal(fn, position) {
+  return function () {
+    var args = Array.prototype.slice.call(arguments);
+    var options = args.length > position + 1 ? args[position] : undefined;
+    var signal = options && options.signal;
+    var callback = args[args.length - 1];
+    var handle;
+    if (!signal) {
+      return fn.apply(null, args);
+    }
+    function onAbort() {
+      handle.cancel();
+    }
+    args[args.length - 1] = function (err, result) {
+      signal.removeEventListener('abort', onAbort);
+      callback(err, result);
+    };
+    // The native side reads signal.aborted itself before queueing.
+    handle = fn.apply(null, args);
+    signal.addEventListener('abort', onAbort, { once: true });
+    return handle;
+  };
+}
+
+/*
+  Micro-batching for VerifyAsync, off until SetVerifyBatching turns it on.
+  Calls made close together are queued and checked by one native
+  VerifyBatchAsync call. Each caller still gets its own result.
+*/
+var nativeVerifyAsync = ed25519.VerifyAsync;
+var nativeVerifyBatchAsync = ed25519.VerifyBatchAsync;
+var verifyBatching = null;
+var verifyQueue = [];
+var verifyQueueDeadline = 0;
+
+function nowMicros() {
+  var time = process.hrtime();
+  return time[0] * 1e6 + time[1] / 1e3;
+}
+
+function isBytes(value, length) {
+  return ArrayBuffer.isView(value) && (length === undefined || value.byteLength === length);
+}
+
+function verifyEach(queue) {
+  queue.forEach(function (item) {
+    try {
+      nativeVerifyAsync(item[0], item[1], item[2], item[3]);
+    } catch (err) {
+      process.nextTick(item[3], err);
+    }
+  });
+}
+
+function flushVerifyQueue() {
+  var queue = verifyQueue;
+  var messages = [];
+  var signatures = [];
+  var publicKeys = [];
+  verifyQueue = [];
+  if (queue.length < 2) {
+    return verifyEach(queue);
+  }
+  queue.forEach(function (item) {
+    messages.push(item[0]);
+    signatures.push(item[1]);
+    publicKeys.push(item[2]);
+  });
+  try {
+    nativeVerifyBatchAsync(messages, signatures, publicKeys, function (err, result) {
+      if (err) {
+        return verifyEach(queue);
+      }
+      queue.forEach(function (item, i) {
+        item[3](null, result.valid || ((result.bitmap[i >> 3] >> (i & 7)) & 1) === 1);
+      });
+    });
+  } catch (err) {
+    verifyEach(queue);
+  }
+}
+
+/*
+  Timers only go down to a millisecond, so the last part of a window is
+  waited out one event loop turn at a time.
+*/
+function scheduleVerifyFlush(queue, left) {
+  var check = function () {
+    if (queue !== verifyQueue) {
+      return;
+    }
+    var remaining = verifyQueueDeadline - nowMicros();
+    if (remaining > 0 && verifyBatching && queue.length < verifyBatching.maxBatch) {
+      return scheduleVerifyFlush(queue, remaining);
+    }
+    flushVerifyQueue();
+  };
+  if (left >= 1000) {
+    setTimeout(check, Math.floor(left / 1000));
+  } else {
+    setImmediate(check);
+  }
+}
+
+function VerifyAsync(message, signature, publicKey, callback) {
+  if (!verifyBatching || !isBytes(message) || !isBytes(signature, 64) || !isBytes(publicKey, 32) ||
+      typeof callback !== 'function') {
+    return nativeVerifyAsync(message, signature, publicKey, callback);
+  }
+  verifyQueue.push([message, signature, publicKey, callback]);
+  if (verifyQueue.length === 1) {
+    verifyQueueDeadline = nowMicros() + verifyBatching.window;
+    scheduleVerifyFlush(verifyQueue, verifyBatching.window);
+  }
+  if (verifyQueue.length >= verifyBatching.maxBatch) {
+    flushVerifyQueue();
+  }
+}
+
+/*
+  SetVerifyBatching(options)
+  Makes VerifyAsync queue its calls and check them together, which costs
+  far less per signature than checking them one by one. Pass false to
+  turn it off again.
+  options.window: how long in microseconds the first queued call waits
+    for others to join it; this caps the added latency. 0, the default,
+    batches the calls made during one event loop turn.
+  options.maxBatch: the queue is checked as soon as it holds this many
+    calls, default 256
+  As with VerifyBatch, the check is multiplied by the cofactor, so a
+  signature crafted with a small order component may be accepted where
+  Verify rejects it. Whether that happens depends on timing: a queue of
+  1 to 3 calls is checked one by one, exactly as Verify does, while 4 or
+  more go through the batch equation. The same message, signature and
+  key can therefore get a different answer depending on how many calls
+  shared its window. Signatures from the signing functions always get
+  Verify's answer. Callers that need the same answer as Verify for any
+  input, such as consensus code, should leave batching off.
+*/
+function SetVerifyBatching(options) {
+  if (options === false || options === null || options === undefined) {
+    verifyBatching = null;
+    return;
+  }
+  var window = options.window === undefined ? 0 : options.window;
+  var maxBatch = options.maxBatch === undefined ? 256 : options.maxBatch;
+  if (typeof window !== 'number' || !(window >= 0) || typeof maxBatch !== 'number' || !(maxBatch >= 1)) {
+    throw new TypeError('SetVerifyBatching requires { window: Number >= 0, maxBatch: Number >= 1 } or false');
+  }
+  verifyBatching = { window: window, maxBatch: maxBatch };
+}
+
+ed25519.MakeKeypairAsync = withPromise(ed25519.MakeKeypairAsync, 1);
+ed25519.SignAsync = withPromise(ed25519.SignAsync, 2);
+ed25519.VerifyAsync = withPromise(VerifyAsync, 3);
+ed25519.SetVerifyBatching = SetVerifyBatching;
+ed25519.SignFile = withPromise(ed25519.SignFile, 2);
+ed25519.VerifyFile = withPromise(ed25519.VerifyFile, 3);
+ed25519.VerifyBatchAsync = withPromise(withSignal(ed25519.VerifyBatchAsync, 3), 4, 3);
+ed25519.SignBatchAsync = withPromise(withSignal(ed25519.SignBatchAsync, 2), 3, 2);
+ed25519.MakeKeypairBatchAsync = withPromise(withSignal(ed25519.MakeKeypairBatchAsync, 1), 2, 1);
+
+/*
+  Feeds every chunk of a fresh stream from open() to signer.update.
+*/
+function readPass(open, signer, callback) {
+  var finished = false;
+  var stream;
+  function finish(err) {
+    if (!finished) {
+      finished = true;
+      callback(err);
+    }
+  }
+  try {
+    stream = open();
+  } catch (err) {
+    return finish(err);
+  }
+  stream.on('data', function (chunk) {
+    try {
+      signer.update(typeof chunk === 'string' ? Buffer.from(chunk) : chunk);
+    } catch (err) {
+      stream.destroy();
+      finish(err);
+    }
+  });
+  stream.on('error', finish);
+  stream.on('end', function () {
+    finish(null);
+  });
+}
+
+/*
+  SignStream(source, key, callback)
+  Signs a message that is too large to hold in memory. Ed25519 hashes the
+  message twice, so source has to be readable twice: either a function
+  returning a new Readable over the whole message on every call, or a
+  file descriptor that is read from offset 0 each time. Only one chunk is
+  in memory at a time. The signature is refused if the second read gives
+  a different message.
+  callback: called with (err, signature)
+*/
+function SignStream(source, key, callback) {
+  var open = source;
+  var signer;
+  if (typeof source === 'number') {
+    open = function () {
+      return fs.createReadStream(null, { fd: source, start: 0, autoClose: false });
+    };
+  }
+  try {
+    if (typeof open !== 'function') {
+      throw new TypeError('SignStream requires a stream factory or a file descriptor');
+    }
+    signer = ed25519.CreateSigner(key);
+  } catch (err) {
+    return process.nextTick(callback, err);
+  }
+  readPass(open, signer, function (err) {
+    if (err) {
+      return callback(err);
+    }
+    signer.rewind();
+    readPass(open, signer, function (err) {
+      var signature;
+      if (err) {
+        return callback(err);
+      }
+      try {
+        signature = signer.final();
+      } catch (err) {
+        return callback(err);
+      }
+      callback(null, signature);
+    });
+  });
+}
+
+ed25519.SignStream = withPromise(SignStream, 2);
@@ -3,12 +3,124 @@
 
 #include <nan.h>
 #include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "ed25519/ed25519.h"
+#include "pool.h"
 
 using namespace v8;
 using namespace node;
 
+/**
+ * Checks that arg is a Buffer, optionally of an exact length.
+ * obj: set to the Buffer when the check passes
+ * returns: true if arg is a usable Buffer
+ **/
+static bool GetBuffer(v8::Local<v8::Value> arg, v8::Local<v8::Object> *obj, size_t length = (size_t)-1) {
+	if (!Buffer::HasInstance(arg)) {
+		return false;
+	}
+	*obj = arg.As<v8::Object>();
+	return length == (size_t)-1 || Buffer::Length(*obj) == length;
+}
+
+/**
+ * Finds the memory behind any ArrayBufferView (Buffer, typed array,
+ * DataView), ArrayBuffer or SharedArrayBuffer, without copying.
+ * data, length: set to the bytes when the check passes
+ * returns: true if arg is one of those types
+ **/
+static bool GetBytes(v8::Local<v8::Value> arg, unsigned char **data, size_t *length) {
+	if (arg->IsArrayBufferView()) {
+		v8::Local<v8::ArrayBufferView> view = arg.As<v8::ArrayBufferView>();
+#if V8_MAJOR_VERSION >= 8
+		*data = (unsigned char*)view->Buffer()->GetBackingStore()->Data() + view->ByteOffset();
+#else
+		*data = (unsigned char*)view->Buffer()->GetContents().Data() + view->ByteOffset();
+#endif
+		*length = view->ByteLength();
+		return true;
+	}
+	if (arg->IsArrayBuffer()) {
+		v8::Local<v8::ArrayBuffer> buffer = arg.As<v8::ArrayBuffer>();
+#if V8_MAJOR_VERSION >= 8
+		*data = (unsigned char*)buffer->GetBackingStore()->Data();
+#else
+		*data = (unsigned char*)buffer->GetContents().Data();
+#endif
+		*length = buffer->ByteLength();
+		return true;
+	}
+	if (arg->IsSharedArrayBuffer()) {
+		v8::Local<v8::SharedArrayBuffer> buffer = arg.As<v8::SharedArrayBuffer>();
+#if V8_MAJOR_VERSION >= 8
+		*data = (unsigned char*)buffer->GetBackingStore()->Data();
+#else
+		*data = (unsigned char*)buffer->GetContents().Data();
+#endif
+		*length = buffer->ByteLength();
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Reads a byte offset or length argument.
+ * returns: false if arg is not a non-negative integer
+ **/
+static bool GetOffset(v8::Local<v8::Value> arg, size_t *offset) {
+	if (!arg->IsNumber()) {
+		return false;
+	}
+	double value = Nan::To<double>(arg).FromJust();
+	if (!(value >= 0) || value > 9007199254740991.0 || value != (double)(size_t)value) {
+		return false;
+	}
+	*offset = (size_t)value;
+	return true;
+}
+
+/**
+ * returns: true if [offset, offset + length) lies inside size bytes
+ **/
+static bool InRange(size_t offset, size_t length, size_t size) {
+	return offset <= size && length <= size - offset;
+}
+
+/**
+ * Finds the key accepted by Sign: a 32 byte seed, a 64 byte private key or a
+ * keyPair object holding a 64 byte privateKey.
+ * keyObj: set to the Buffer holding the seed or private key
+ * returns: 32 for a seed, 64 for a private key, 0 if keyArg is not a key
+ **/
+static size_t GetSigningKey(v8::Local<v8::Value> keyArg, v8::Local<v8::Object> *keyObj) {
+	if (Buffer::HasInstance(keyArg)) {
+		*keyObj = keyArg.As<v8::Object>();
+		size_t length = Buffer::Length(*keyObj);
+		return (length == 32 || length == 64) ? length : 0;
+	}
+	if (!keyArg->IsObject()) {
+		return 0;
+	}
+	v8::Local<v8::Value> privateKeyPropertyObj;
+	if (!keyArg.As<v8::Object>()->Get(Nan::GetCurrentContext(), Nan::New<String>("privateKey").ToLocalChecked()).ToLocal(&privateKeyPropertyObj) ||
+		!GetBuffer(privateKeyPropertyObj, keyObj, 64)) {
+		return 0;
+	}
+	return 64;
+}
+
 /**
  * MakeKeypair(Buffer seed)
  * seed: A 32 byte buffer
@@ -48,6 +160,59 @@ NAN_METHOD(MakeKeypair) {
 	info.GetReturnValue().Set(result);
 }
 
+/**
+ * MakeKeypairInto(Buffer seed, Buffer publicKey, Buffer privateKey)
+ * Same as MakeKeypair, but writes the keys into caller supplied Buffers.
+ * publicKey: a 32 byte buffer to receive the public key
+ * privateKey: a 64 byte buffer to receive the private key, may be seed
+ *             itself or share its first 32 bytes
+ **/
+NAN_METHOD(MakeKeypairInto) {
+	v8::Local<v8::Object> seed;
+	v8::Local<v8::Object> publicKey;
+	v8::Local<v8::Object> privateKey;
+	if (info.Length() < 3 ||
+		!GetBuffer(info[0], &seed, 32) ||
+		!GetBuffer(info[1], &publicKey, 32) ||
+		!GetBuffer(info[2], &privateKey, 64)) {
+		return Nan::ThrowError("MakeKeypairInto requires (Buffer(32), Buffer(32), Buffer(64))");
+	}
+
+	unsigned char* privateKeyData = (unsigned char*)Buffer::Data(privateKey);
+	memmove(privateKeyData, Buffer::Data(seed), 32);
+	crypto_sign_keypair((unsigned char*)Buffer::Data(publicKey), privateKeyData);
+}
+
+/**
+ * MakeKeypairBatch(Buffer seeds)
+ * Same as MakeKeypair for every 32 byte seed in seeds, with the public
+ * keys encoded together so the batch shares its field inversions.
+ * returns: { publicKeys: Buffer, privateKeys: Buffer } holding key i at
+ *   offset 32 * i and 64 * i
+ **/
+NAN_METHOD(MakeKeypairBatch) {
+	v8::Local<v8::Object> seeds;
+	if (info.Length() < 1 ||
+		!GetBuffer(info[0], &seeds) ||
+		Buffer::Length(seeds) % 32 != 0) {
+		return Nan::ThrowError("MakeKeypairBatch requires (Buffer(32 * n))");
+	}
+
+	size_t count = Buffer::Length(seeds) / 32;
+	v8::Local<v8::Object> publicKeys = Nan::NewBuffer(32 * count).ToLocalChecked();
+	v8::Local<v8::Object> privateKeys = Nan::NewBuffer(64 * count).ToLocalChecked();
+	unsigned char* privateKeyData = (unsigned char*)Buffer::Data(privateKeys);
+	for (size_t i = 0; i < count; i++) {
+		memcpy(privateKeyData + 64 * i, Buffer::Data(seeds) + 32 * i, 32);
+	}
+	crypto_sign_keypair_batch((unsigned char*)Buffer::Data(publicKeys), privateKeyData, count);
+
+	v8::Local<v8::Object> result = Nan::New<Object>();
+	Nan::Set(result, Nan::New("publicKeys").ToLocalChecked(), publicKeys);
+	Nan::Set(result, Nan::New("privateKeys").ToLocalChecked(), privateKeys);
+	info.GetReturnValue().Set(result);
+}
+
 /**
  * Sign(Buffer message, Buffer seed)
  * Sign(Buffer message, Buffer privateKey)
@@ -63,54 +228,473 @@ NAN_METHOD(Sign) {
 
     v8::Local<v8::Object> messageObj;
     
-	v8::Local<v8::Object> obj1;
+	v8::Local<v8::Object> keyObj;
+	size_t keyLength = 0;
     if (info.Length() < 2 ||
 	    !info[0]->ToObject(Nan::GetCurrentContext()).ToLocal(&messageObj) ||
 		!Buffer::HasInstance(messageObj) ||
-	    !info[1]->ToObject(Nan::GetCurrentContext()).ToLocal(&obj1)) {
+		(keyLength = GetSigningKey(info[1], &keyObj)) == 0) {
 		return Nan::ThrowError("Sign requires (Buffer, {Buffer(32 or 64) | keyPair object})");
 	}
 
     unsigned char privateKeyData[64];  // Place outside of the block it's used in - possible macOS compiler bug.
-    bool obj1IsBuffer = Buffer::HasInstance(obj1);
-	size_t obj1BufferLength = obj1IsBuffer ? Buffer::Length(obj1) : 0;
-	if (obj1IsBuffer && obj1BufferLength == 32) {
-		unsigned char* seed = (unsigned char*)Buffer::Data(obj1);
+	if (keyLength == 32) {
+		unsigned char* seed = (unsigned char*)Buffer::Data(keyObj);
 		unsigned char publicKeyData[32];
 		for (int i = 0; i < 32; i++) {
 			privateKeyData[i] = seed[i];
 		}
 		crypto_sign_keypair(publicKeyData, privateKeyData);
 		privateKey = privateKeyData;
-    } else if (obj1IsBuffer && obj1BufferLength == 64) {
-		privateKey = (unsigned char*)Buffer::Data(obj1);
-	} else if (obj1->IsObject() && !obj1IsBuffer) {
-		v8::Local<v8::Value> privateKeyPropertyObj;
-		v8::Local<v8::Object> privateKeyBufferObj;
-		if (!(obj1->Get(Nan::GetCurrentContext(), Nan::New<String>("privateKey").ToLocalChecked())).ToLocal(&privateKeyPropertyObj) ||
-			!privateKeyPropertyObj->ToObject(Nan::GetCurrentContext()).ToLocal(&privateKeyBufferObj) ||
-			!Buffer::HasInstance(privateKeyBufferObj)) {
-			return Nan::ThrowError("Sign requires (Buffer, {Buffer(32 or 64) | keyPair object})");
-		}
-		privateKey = (unsigned char*)Buffer::Data(privateKeyBufferObj);
 	} else {
-		return Nan::ThrowError("Sign requires (Buffer, {Buffer(32 or 64) | keyPair object})");
+		privateKey = (unsigned char*)Buffer::Data(keyObj);
 	}
 
 	const unsigned char* messageData = (unsigned char*)Buffer::Data(messageObj);
 	size_t messageLen = Buffer::Length(messageObj);
-	unsigned long long sigLen = 64 + messageLen;
-	unsigned char *signatureMessageData = (unsigned char*) malloc(sigLen);
-	crypto_sign(signatureMessageData, &sigLen, messageData, messageLen, privateKey);
-
 	v8::Local<v8::Object> signature = Nan::NewBuffer(64).ToLocalChecked();
-	unsigned char* signatureData = (unsigned char*)Buffer::Data(signature);
-	for (int i = 0; i < 64; i++) {
-		signatureData[i] = signatureMessageData[i];
+	crypto_sign_detached((unsigned char*)Buffer::Data(signature), messageData, messageLen, privateKey);
+	info.GetReturnValue().Set(signature);
+}
+
+/**
+ * SignInto(Buffer message, {Buffer seed | Buffer privateKey | Object keyPair}, Buffer out, Number offset)
+ * Same as Sign, but writes the 64 byte signature into out at offset
+ * instead of allocating a new Buffer.
+ * offset: where the signature starts in out, 0 if left out
+ **/
+NAN_METHOD(SignInto) {
+	v8::Local<v8::Object> message;
+	v8::Local<v8::Object> keyObj;
+	v8::Local<v8::Object> out;
+	size_t keyLength = 0;
+	if (info.Length() < 3 ||
+		!GetBuffer(info[0], &message) ||
+		(keyLength = GetSigningKey(info[1], &keyObj)) == 0 ||
+		!GetBuffer(info[2], &out)) {
+		return Nan::ThrowError("SignInto requires (Buffer, {Buffer(32 or 64) | keyPair object}, Buffer, Number)");
 	}
 
-	free(signatureMessageData);
-	info.GetReturnValue().Set(signature);
+	double offset = 0;
+	if (info.Length() > 3 && !info[3]->IsUndefined()) {
+		if (!info[3]->IsNumber()) {
+			return Nan::ThrowError("SignInto requires (Buffer, {Buffer(32 or 64) | keyPair object}, Buffer, Number)");
+		}
+		offset = Nan::To<double>(info[3]).FromJust();
+	}
+	if (!(offset >= 0) || offset + 64 > (double)Buffer::Length(out) || offset != (double)(size_t)offset) {
+		return Nan::ThrowRangeError("SignInto offset must leave 64 bytes in the output Buffer");
+	}
+
+	unsigned char privateKeyData[64];
+	unsigned char* privateKey = (unsigned char*)Buffer::Data(keyObj);
+	if (keyLength == 32) {
+		unsigned char publicKeyData[32];
+		memcpy(privateKeyData, privateKey, 32);
+		crypto_sign_keypair(publicKeyData, privateKeyData);
+		privateKey = privateKeyData;
+	}
+
+	unsigned char* signatureData = (unsigned char*)Buffer::Data(out) + (size_t)offset;
+	crypto_sign_detached(signatureData, (unsigned char*)Buffer::Data(message), Buffer::Length(message), privateKey);
+}
+
+/**
+ * SignAt(buffer, Number msgOffset, Number msgLen, Number sigOffset, {Buffer seed | Buffer privateKey | Object keyPair})
+ * Same as Sign for the msgLen bytes at msgOffset in buffer, writing the 64
+ * byte signature into buffer at sigOffset. The signature may overlap the
+ * message.
+ * buffer: any ArrayBufferView, ArrayBuffer or SharedArrayBuffer, used in place
+ **/
+NAN_METHOD(SignAt) {
+	unsigned char* data;
+	size_t length;
+	size_t msgOffset;
+	size_t msgLen;
+	size_t sigOffset;
+	v8::Local<v8::Object> keyObj;
+	size_t keyLength = 0;
+	if (info.Length() < 5 ||
+		!GetBytes(info[0], &data, &length) ||
+		!GetOffset(info[1], &msgOffset) ||
+		!GetOffset(info[2], &msgLen) ||
+		!GetOffset(info[3], &sigOffset) ||
+		(keyLength = GetSigningKey(info[4], &keyObj)) == 0) {
+		return Nan::ThrowError("SignAt requires (ArrayBufferView or ArrayBuffer, Number, Number, Number, {Buffer(32 or 64) | keyPair object})");
+	}
+	if (!InRange(msgOffset, msgLen, length) || !InRange(sigOffset, 64, length)) {
+		return Nan::ThrowRangeError("SignAt message and signature must lie inside the buffer");
+	}
+
+	unsigned char privateKeyData[64];
+	unsigned char* privateKey = (unsigned char*)Buffer::Data(keyObj);
+	if (keyLength == 32) {
+		unsigned char publicKeyData[32];
+		memcpy(privateKeyData, privateKey, 32);
+		crypto_sign_keypair(publicKeyData, privateKeyData);
+		privateKey = privateKeyData;
+	}
+
+	crypto_sign_detached(data + sigOffset, data + msgOffset, msgLen, privateKey);
+}
+
+/**
+ * Collects pointers into an array of Buffers. When keep is given every
+ * Buffer is also stored in it, for an async job to pin.
+ * returns: false if an element is not a Buffer
+ **/
+static bool GetMessages(v8::Local<v8::Array> messages, std::vector<const unsigned char*> *data, std::vector<size_t> *lens, v8::Local<v8::Array> keep = v8::Local<v8::Array>()) {
+	size_t count = messages->Length();
+	data->resize(count);
+	lens->resize(count);
+	for (size_t i = 0; i < count; i++) {
+		v8::Local<v8::Value> message;
+		if (!Nan::Get(messages, i).ToLocal(&message) || !Buffer::HasInstance(message)) {
+			return false;
+		}
+		(*data)[i] = (unsigned char*)Buffer::Data(message);
+		(*lens)[i] = Buffer::Length(message);
+		if (!keep.IsEmpty()) {
+			Nan::Set(keep, i, message);
+		}
+	}
+	return true;
+}
+
+/**
+ * SignBatch(Array messages, Buffer seed)
+ * SignBatch(Array messages, Buffer privateKey)
+ * SignBatch(Array messages, Object keyPair)
+ * messages: Buffers to be signed with the same key
+ * returns: a Buffer holding the 64 byte signature of message i at offset 64 * i
+ **/
+NAN_METHOD(SignBatch) {
+	v8::Local<v8::Object> keyObj;
+	size_t keyLength = 0;
+	if (info.Length() < 2 ||
+		!info[0]->IsArray() ||
+		(keyLength = GetSigningKey(info[1], &keyObj)) == 0) {
+		return Nan::ThrowError("SignBatch requires ([Buffer], {Buffer(32 or 64) | keyPair object})");
+	}
+
+	std::vector<const unsigned char*> messageData;
+	std::vector<size_t> messageLen;
+	if (!GetMessages(info[0].As<v8::Array>(), &messageData, &messageLen)) {
+		return Nan::ThrowError("SignBatch requires ([Buffer], {Buffer(32 or 64) | keyPair object})");
+	}
+	size_t count = messageData.size();
+
+	unsigned char privateKeyData[64];
+	unsigned char* privateKey = (unsigned char*)Buffer::Data(keyObj);
+	if (keyLength == 32) {
+		unsigned char publicKeyData[32];
+		memcpy(privateKeyData, privateKey, 32);
+		crypto_sign_keypair(publicKeyData, privateKeyData);
+		privateKey = privateKeyData;
+	}
+
+	v8::Local<v8::Object> signatures = Nan::NewBuffer(64 * count).ToLocalChecked();
+	crypto_sign_batch((unsigned char*)Buffer::Data(signatures), messageData.data(), messageLen.data(), count, privateKey);
+	info.GetReturnValue().Set(signatures);
+}
+
+/**
+ * new SigningKey(Buffer seed)
+ * new SigningKey(Buffer privateKey)
+ * new SigningKey(Object keyPair)
+ * Holds the expanded secret scalar, nonce prefix and public key in native
+ * memory so each sign() only hashes the message twice and does one base
+ * point multiplication.
+ * publicKey: the 32 byte public key, set on the new object
+ **/
+class SigningKey : public Nan::ObjectWrap {
+public:
+	static void Init(v8::Local<v8::Object> exports) {
+		v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+		tpl->SetClassName(Nan::New("SigningKey").ToLocalChecked());
+		tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		Nan::SetPrototypeMethod(tpl, "sign", Sign);
+		Nan::Set(exports, Nan::New("SigningKey").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
+	}
+
+private:
+	~SigningKey() {
+		volatile unsigned char *p = az;
+		for (int i = 0; i < 64; i++) {
+			p[i] = 0;
+		}
+	}
+
+	static NAN_METHOD(New) {
+		if (!info.IsConstructCall()) {
+			return Nan::ThrowTypeError("SigningKey must be called with new");
+		}
+		v8::Local<v8::Object> keyObj;
+		size_t keyLength = GetSigningKey(info[0], &keyObj);
+		if (keyLength == 0) {
+			return Nan::ThrowError("SigningKey requires {Buffer(32 or 64) | keyPair object}");
+		}
+
+		SigningKey *key = new SigningKey();
+		unsigned char privateKeyData[64];
+		memcpy(privateKeyData, Buffer::Data(keyObj), keyLength);
+		if (keyLength == 32) {
+			crypto_sign_keypair(privateKeyData + 32, privateKeyData);
+		}
+		crypto_sign_expand(key->az, privateKeyData);
+		memcpy(key->publicKey, privateKeyData + 32, 32);
+		memset(privateKeyData, 0, 64);
+
+		key->Wrap(info.This());
+		v8::Local<v8::Object> publicKey = Nan::CopyBuffer((char*)key->publicKey, 32).ToLocalChecked();
+		Nan::Set(info.This(), Nan::New("publicKey").ToLocalChecked(), publicKey);
+		info.GetReturnValue().Set(info.This());
+	}
+
+	/**
+	 * sign(Buffer message)
+	 * returns: the 64 byte signature as a Buffer, the same as Sign gives
+	 **/
+	static NAN_METHOD(Sign) {
+		SigningKey *key = Nan::ObjectWrap::Unwrap<SigningKey>(info.Holder());
+		v8::Local<v8::Object> message;
+		if (info.Length() < 1 || !GetBuffer(info[0], &message)) {
+			return Nan::ThrowError("sign requires a Buffer");
+		}
+
+		v8::Local<v8::Object> signature = Nan::NewBuffer(64).ToLocalChecked();
+		crypto_sign_detached_expanded((unsigned char*)Buffer::Data(signature),
+			(unsigned char*)Buffer::Data(message), Buffer::Length(message), key->az, key->publicKey);
+		info.GetReturnValue().Set(signature);
+	}
+
+	unsigned char az[64];
+	unsigned char publicKey[32];
+};
+
+/**
+ * Bounded LRU cache of decoded public keys for Verify and VerifyAsync,
+ * keyed by the 32 key bytes. Each entry holds the key's precomputed
+ * table, or nothing for a key that does not decode so it is rejected
+ * without decoding it again. Disabled until SetVerifyCacheSize is called.
+ * Shared by every thread; entries are reference counted so a key evicted
+ * while a worker is using it stays alive until that worker is done.
+ **/
+class VerifyKeyCache {
+public:
+	typedef std::shared_ptr<crypto_sign_verifying_key> Key;
+
+	VerifyKeyCache() : capacity(0), hits(0), misses(0) {}
+
+	/**
+	 * Finds or decodes publicKey.
+	 * returns: false if the cache is disabled, else true with key set,
+	 *          to NULL if publicKey is not a valid point
+	 **/
+	bool Get(const unsigned char *publicKey, Key *key) {
+		std::string id((const char*)publicKey, 32);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (capacity == 0) {
+				return false;
+			}
+			Map::iterator found = map.find(id);
+			if (found != map.end()) {
+				hits++;
+				entries.splice(entries.begin(), entries, found->second);
+				*key = found->second->second;
+				return true;
+			}
+			misses++;
+		}
+
+		// Decode outside the lock; two threads may race to insert the same key.
+		int status;
+		*key = Key(crypto_sign_verifying_key_new(publicKey, &status), crypto_sign_verifying_key_free);
+		if (status == -1) {
+			// Out of memory rather than an invalid key: do not remember it.
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (capacity > 0 && map.find(id) == map.end()) {
+			entries.push_front(Entry(id, *key));
+			map[id] = entries.begin();
+			Trim();
+		}
+		return true;
+	}
+
+	void SetCapacity(size_t size) {
+		std::lock_guard<std::mutex> lock(mutex);
+		capacity = size;
+		Trim();
+	}
+
+	void Stats(size_t *size, size_t *cap, double *hitCount, double *missCount) {
+		std::lock_guard<std::mutex> lock(mutex);
+		*size = map.size();
+		*cap = capacity;
+		*hitCount = (double)hits;
+		*missCount = (double)misses;
+	}
+
+private:
+	typedef std::pair<std::string, Key> Entry;
+	typedef std::unordered_map<std::string, std::list<Entry>::iterator> Map;
+
+	void Trim() {
+		while (map.size() > capacity) {
+			map.erase(entries.back().first);
+			entries.pop_back();
+		}
+	}
+
+	std::mutex mutex;
+	std::list<Entry> entries;
+	Map map;
+	size_t capacity;
+	unsigned long long hits;
+	unsigned long long misses;
+};
+
+static VerifyKeyCache verifyKeyCache;
+
+/**
+ * crypto_sign_verify through verifyKeyCache when it is enabled.
+ * returns: 0 if the signature is valid
+ **/
+static int VerifyWithCache(const unsigned char *signature, const unsigned char *message, size_t messageLen, const unsigned char *publicKey) {
+	VerifyKeyCache::Key key;
+	if (!verifyKeyCache.Get(publicKey, &key)) {
+		return crypto_sign_verify(signature, message, messageLen, publicKey);
+	}
+	if (!key) {
+		return -2;
+	}
+	return crypto_sign_verify_with_key(signature, message, messageLen, key.get());
+}
+
+/**
+ * Signer, returned by CreateSigner, signs a message given in pieces.
+ * Ed25519 needs the message twice: pass it through update() once, call
+ * rewind(), pass the same bytes through update() again, then call
+ * final(). SignStream in index.js drives this from a re-readable source.
+ **/
+class Signer : public Nan::ObjectWrap {
+public:
+	static void Init() {
+		v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+		tpl->SetClassName(Nan::New("Signer").ToLocalChecked());
+		tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		Nan::SetPrototypeMethod(tpl, "update", Update);
+		Nan::SetPrototypeMethod(tpl, "rewind", Rewind);
+		Nan::SetPrototypeMethod(tpl, "final", Final);
+		constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
+	}
+
+	static Nan::MaybeLocal<v8::Object> NewInstance(v8::Local<v8::Value> key) {
+		v8::Local<v8::Value> argv[] = { key };
+		return Nan::NewInstance(Nan::New(constructor), 1, argv);
+	}
+
+private:
+	explicit Signer(crypto_sign_signer *state) : state(state) {}
+
+	~Signer() {
+		crypto_sign_signer_free(state);
+	}
+
+	static NAN_METHOD(New) {
+		v8::Local<v8::Object> keyObj;
+		size_t keyLength = GetSigningKey(info[0], &keyObj);
+		if (keyLength == 0) {
+			return Nan::ThrowError("CreateSigner requires {Buffer(32 or 64) | keyPair object}");
+		}
+
+		unsigned char privateKeyData[64];
+		memcpy(privateKeyData, Buffer::Data(keyObj), keyLength);
+		if (keyLength == 32) {
+			crypto_sign_keypair(privateKeyData + 32, privateKeyData);
+		}
+		crypto_sign_signer *state = crypto_sign_signer_new(privateKeyData);
+		memset(privateKeyData, 0, 64);
+		if (state == NULL) {
+			return Nan::ThrowError("CreateSigner could not allocate memory");
+		}
+		(new Signer(state))->Wrap(info.This());
+		info.GetReturnValue().Set(info.This());
+	}
+
+	/**
+	 * update(Buffer chunk)
+	 * Hashes the next piece of the message for the current pass.
+	 * returns: this
+	 **/
+	static NAN_METHOD(Update) {
+		Signer *self = Nan::ObjectWrap::Unwrap<Signer>(info.Holder());
+		v8::Local<v8::Object> chunk;
+		if (info.Length() < 1 || !GetBuffer(info[0], &chunk)) {
+			return Nan::ThrowError("update requires a Buffer");
+		}
+		if (self->state == NULL) {
+			return Nan::ThrowError("update called after final");
+		}
+		crypto_sign_signer_update(self->state, (unsigned char*)Buffer::Data(chunk), Buffer::Length(chunk));
+		info.GetReturnValue().Set(info.Holder());
+	}
+
+	/**
+	 * rewind()
+	 * Ends the first pass over the message and starts the second.
+	 **/
+	static NAN_METHOD(Rewind) {
+		Signer *self = Nan::ObjectWrap::Unwrap<Signer>(info.Holder());
+		if (self->state == NULL || crypto_sign_signer_rewind(self->state) != 0) {
+			return Nan::ThrowError("rewind may only be called once, before final");
+		}
+	}
+
+	/**
+	 * final()
+	 * returns: the 64 byte signature, the same as Sign gives for the
+	 *          message; throws if the second pass saw a different message
+	 **/
+	static NAN_METHOD(Final) {
+		Signer *self = Nan::ObjectWrap::Unwrap<Signer>(info.Holder());
+		if (self->state == NULL) {
+			return Nan::ThrowError("final called twice");
+		}
+		v8::Local<v8::Object> signature = Nan::NewBuffer(64).ToLocalChecked();
+		int result = crypto_sign_signer_final(self->state, (unsigned char*)Buffer::Data(signature));
+		if (result == -1) {
+			return Nan::ThrowError("final requires rewind and a second pass first");
+		}
+		crypto_sign_signer_free(self->state);
+		self->state = NULL;
+		if (result != 0) {
+			return Nan::ThrowError("the message changed between the two passes");
+		}
+		info.GetReturnValue().Set(signature);
+	}
+
+	static Nan::Persistent<v8::Function> constructor;
+	crypto_sign_signer *state;
+};
+
+Nan::Persistent<v8::Function> Signer::constructor;
+
+/**
+ * CreateSigner(Buffer seed)
+ * CreateSigner(Buffer privateKey)
+ * CreateSigner(Object keyPair)
+ * returns: a Signer for a message that is read twice in pieces
+ **/
+NAN_METHOD(CreateSigner) {
+	v8::Local<v8::Object> signer;
+	if (Signer::NewInstance(info[0]).ToLocal(&signer)) {
+		info.GetReturnValue().Set(signer);
+	}
 }
 
 /**
@@ -142,14 +726,1380 @@ NAN_METHOD(Verify) {
 	unsigned char* signatureData = (unsigned char*)Buffer::Data(signature);
 	unsigned char* publicKeyData = (unsigned char*)Buffer::Data(publicKey);
 
-	info.GetReturnValue().Set(crypto_sign_verify(signatureData, messageData, messageLen, publicKeyData) == 0);
+	info.GetReturnValue().Set(VerifyWithCache(signatureData, messageData, messageLen, publicKeyData) == 0);
+}
+
+/**
+ * VerifyAt(buffer, Number msgOffset, Number msgLen, Number sigOffset, Number pkOffset)
+ * Same as Verify, reading the message, 64 byte signature and 32 byte public
+ * key from their offsets in buffer, so packed frames need no slicing.
+ * buffer: any ArrayBufferView, ArrayBuffer or SharedArrayBuffer, used in
+ *   place; another thread writing to a shared buffer meanwhile changes what
+ *   is verified
+ * returns: true if the signature is valid
+ **/
+NAN_METHOD(VerifyAt) {
+	unsigned char* data;
+	size_t length;
+	size_t msgOffset;
+	size_t msgLen;
+	size_t sigOffset;
+	size_t pkOffset;
+	if (info.Length() < 5 ||
+		!GetBytes(info[0], &data, &length) ||
+		!GetOffset(info[1], &msgOffset) ||
+		!GetOffset(info[2], &msgLen) ||
+		!GetOffset(info[3], &sigOffset) ||
+		!GetOffset(info[4], &pkOffset)) {
+		return Nan::ThrowError("VerifyAt requires (ArrayBufferView or ArrayBuffer, Number, Number, Number, Number)");
+	}
+	if (!InRange(msgOffset, msgLen, length) || !InRange(sigOffset, 64, length) || !InRange(pkOffset, 32, length)) {
+		return Nan::ThrowRangeError("VerifyAt message, signature and public key must lie inside the buffer");
+	}
+
+	info.GetReturnValue().Set(VerifyWithCache(data + sigOffset, data + msgOffset, msgLen, data + pkOffset) == 0);
+}
+
+/**
+ * SetVerifyCacheSize(Number size)
+ * Caches up to size decoded public keys for Verify and VerifyAsync, so
+ * repeated keys skip decompression and get a wider precomputed table.
+ * Each entry takes about 4 KB. 0, the default, disables the cache.
+ **/
+NAN_METHOD(SetVerifyCacheSize) {
+	if (info.Length() < 1 || !info[0]->IsNumber() || !(Nan::To<double>(info[0]).FromJust() >= 0)) {
+		return Nan::ThrowError("SetVerifyCacheSize requires a Number >= 0");
+	}
+	double size = Nan::To<double>(info[0]).FromJust();
+	verifyKeyCache.SetCapacity(size > 1e9 ? (size_t)1e9 : (size_t)size);
+}
+
+/**
+ * GetVerifyCacheStats()
+ * returns: an Object with the cache's size, capacity, hits and misses
+ **/
+NAN_METHOD(GetVerifyCacheStats) {
+	size_t size;
+	size_t capacity;
+	double hits;
+	double misses;
+	verifyKeyCache.Stats(&size, &capacity, &hits, &misses);
+
+	v8::Local<v8::Object> result = Nan::New<Object>();
+	Nan::Set(result, Nan::New("size").ToLocalChecked(), Nan::New((double)size));
+	Nan::Set(result, Nan::New("capacity").ToLocalChecked(), Nan::New((double)capacity));
+	Nan::Set(result, Nan::New("hits").ToLocalChecked(), Nan::New(hits));
+	Nan::Set(result, Nan::New("misses").ToLocalChecked(), Nan::New(misses));
+	info.GetReturnValue().Set(result);
+}
+
+
+/**
+ * Fills out with unpredictable bytes for the batch verification coefficients.
+ **/
+static void GetBatchRandom(unsigned char out[32]) {
+#if UV_VERSION_HEX >= 0x012100
+	if (uv_random(NULL, NULL, out, 32, 0, NULL) == 0) {
+		return;
+	}
+#endif
+	std::random_device device;
+	for (int i = 0; i < 32; i += 4) {
+		unsigned int value = device();
+		memcpy(out + i, &value, 4);
+	}
+}
+
+/**
+ * Packs one byte per item into a Buffer with one bit per item.
+ * Bit (i % 8) of byte (i / 8) is set when item i is valid.
+ **/
+static v8::Local<v8::Object> NewBitmap(const unsigned char* valid, size_t count) {
+	v8::Local<v8::Object> bitmap = Nan::NewBuffer((count + 7) / 8).ToLocalChecked();
+	unsigned char* bitmapData = (unsigned char*)Buffer::Data(bitmap);
+	memset(bitmapData, 0, (count + 7) / 8);
+	for (size_t i = 0; i < count; i++) {
+		bitmapData[i / 8] |= (valid[i] & 1) << (i % 8);
+	}
+	return bitmap;
 }
 
+/**
+ * new VerifyingKey(Buffer publicKey)
+ * Decompresses publicKey once and keeps a table of its odd multiples in
+ * native memory, so verify() skips all per-key setup.
+ * publicKey: a 32 byte public key; throws if it is not a valid point
+ **/
+class VerifyingKey : public Nan::ObjectWrap {
+public:
+	static void Init(v8::Local<v8::Object> exports) {
+		v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+		tpl->SetClassName(Nan::New("VerifyingKey").ToLocalChecked());
+		tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		Nan::SetPrototypeMethod(tpl, "verify", Verify);
+		Nan::Set(exports, Nan::New("VerifyingKey").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
+	}
+
+private:
+	explicit VerifyingKey(crypto_sign_verifying_key *key) : key(key) {}
+
+	~VerifyingKey() {
+		crypto_sign_verifying_key_free(key);
+	}
+
+	static NAN_METHOD(New) {
+		if (!info.IsConstructCall()) {
+			return Nan::ThrowTypeError("VerifyingKey must be called with new");
+		}
+		v8::Local<v8::Object> publicKey;
+		if (info.Length() < 1 || !GetBuffer(info[0], &publicKey, 32)) {
+			return Nan::ThrowError("VerifyingKey requires a Buffer(32)");
+		}
+		int status;
+		crypto_sign_verifying_key *key = crypto_sign_verifying_key_new((unsigned char*)Buffer::Data(publicKey), &status);
+		if (status == -1) {
+			return Nan::ThrowError("VerifyingKey ran out of memory");
+		}
+		if (key == NULL) {
+			return Nan::ThrowError("VerifyingKey requires a valid public key");
+		}
+
+		(new VerifyingKey(key))->Wrap(info.This());
+		Nan::Set(info.This(), Nan::New("publicKey").ToLocalChecked(),
+			Nan::CopyBuffer(Buffer::Data(publicKey), 32).ToLocalChecked());
+		info.GetReturnValue().Set(info.This());
+	}
+
+	/**
+	 * verify(Buffer message, Buffer signature)
+	 * returns: boolean, the same as Verify gives for this public key
+	 **/
+	static NAN_METHOD(Verify) {
+		VerifyingKey *self = Nan::ObjectWrap::Unwrap<VerifyingKey>(info.Holder());
+		v8::Local<v8::Object> message;
+		v8::Local<v8::Object> signature;
+		if (info.Length() < 2 ||
+			!GetBuffer(info[0], &message) ||
+			!GetBuffer(info[1], &signature, 64)) {
+			return Nan::ThrowError("verify requires (Buffer, Buffer(64))");
+		}
+
+		info.GetReturnValue().Set(crypto_sign_verify_with_key((unsigned char*)Buffer::Data(signature),
+			(unsigned char*)Buffer::Data(message), Buffer::Length(message), self->key) == 0);
+	}
+
+	crypto_sign_verifying_key *key;
+};
+
+/**
+ * Verifier, returned by CreateVerifier, checks a signature over a message
+ * given in pieces. Only the SHA-512 state is kept between update() calls,
+ * so memory use does not depend on the message size.
+ **/
+class Verifier : public Nan::ObjectWrap {
+public:
+	static void Init() {
+		v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+		tpl->SetClassName(Nan::New("Verifier").ToLocalChecked());
+		tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		Nan::SetPrototypeMethod(tpl, "update", Update);
+		Nan::SetPrototypeMethod(tpl, "final", Final);
+		constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
+	}
+
+	static Nan::MaybeLocal<v8::Object> NewInstance(v8::Local<v8::Value> signature, v8::Local<v8::Value> publicKey) {
+		v8::Local<v8::Value> argv[] = { signature, publicKey };
+		return Nan::NewInstance(Nan::New(constructor), 2, argv);
+	}
+
+private:
+	explicit Verifier(crypto_sign_verifier *state) : state(state) {}
+
+	~Verifier() {
+		crypto_sign_verifier_free(state);
+	}
+
+	static NAN_METHOD(New) {
+		v8::Local<v8::Object> signature;
+		v8::Local<v8::Object> publicKey;
+		if (info.Length() < 2 ||
+			!GetBuffer(info[0], &signature, 64) ||
+			!GetBuffer(info[1], &publicKey, 32)) {
+			return Nan::ThrowError("CreateVerifier requires (Buffer(64), Buffer(32))");
+		}
+		crypto_sign_verifier *state = crypto_sign_verifier_new((unsigned char*)Buffer::Data(signature),
+			(unsigned char*)Buffer::Data(publicKey));
+		if (state == NULL) {
+			return Nan::ThrowError("CreateVerifier could not allocate memory");
+		}
+		(new Verifier(state))->Wrap(info.This());
+		info.GetReturnValue().Set(info.This());
+	}
+
+	/**
+	 * update(Buffer chunk)
+	 * Hashes the next piece of the message.
+	 * returns: this
+	 **/
+	static NAN_METHOD(Update) {
+		Verifier *self = Nan::ObjectWrap::Unwrap<Verifier>(info.Holder());
+		v8::Local<v8::Object> chunk;
+		if (info.Length() < 1 || !GetBuffer(info[0], &chunk)) {
+			return Nan::ThrowError("update requires a Buffer");
+		}
+		if (self->state == NULL) {
+			return Nan::ThrowError("update called after final");
+		}
+		crypto_sign_verifier_update(self->state, (unsigned char*)Buffer::Data(chunk), Buffer::Length(chunk));
+		info.GetReturnValue().Set(info.Holder());
+	}
+
+	/**
+	 * final()
+	 * returns: boolean, what Verify gives for the whole message
+	 **/
+	static NAN_METHOD(Final) {
+		Verifier *self = Nan::ObjectWrap::Unwrap<Verifier>(info.Holder());
+		if (self->state == NULL) {
+			return Nan::ThrowError("final called twice");
+		}
+		bool valid = crypto_sign_verifier_final(self->state) == 0;
+		crypto_sign_verifier_free(self->state);
+		self->state = NULL;
+		info.GetReturnValue().Set(valid);
+	}
+
+	static Nan::Persistent<v8::Function> constructor;
+	crypto_sign_verifier *state;
+};
+
+Nan::Persistent<v8::Function> Verifier::constructor;
+
+/**
+ * CreateVerifier(Buffer signature, Buffer publicKey)
+ * signature: the 64 byte signature to check
+ * publicKey: the 32 byte public key
+ * returns: a Verifier; feed it the message with update(chunk), then
+ *          final() gives true if the signature is valid
+ **/
+NAN_METHOD(CreateVerifier) {
+	v8::Local<v8::Object> verifier;
+	if (Verifier::NewInstance(info[0], info[1]).ToLocal(&verifier)) {
+		info.GetReturnValue().Set(verifier);
+	}
+}
+
+/**
+ * The arguments of a VerifyBatch call, as pointers into their Buffers.
+ **/
+struct VerifyBatchItems {
+	std::vector<const unsigned char*> messages;
+	std::vector<size_t> messageLens;
+	std::vector<const unsigned char*> signatures;
+	std::vector<const unsigned char*> publicKeys;
+};
+
+/**
+ * Checks the (messages, signatures, publicKeys) arrays starting at
+ * info[0] and fills items, throwing with name in the message on bad
+ * input. When keep is given every Buffer is also stored in it, so an
+ * async job can pin them even if the caller changes the arrays.
+ * returns: false if an error was thrown
+ **/
+static bool GetVerifyBatchItems(const Nan::FunctionCallbackInfo<v8::Value> &info, const char *name, VerifyBatchItems *items, v8::Local<v8::Array> keep = v8::Local<v8::Array>()) {
+	std::string prefix(name);
+	if (info.Length() < 3 ||
+		!info[0]->IsArray() ||
+		!info[1]->IsArray() ||
+		!info[2]->IsArray()) {
+		Nan::ThrowError((prefix + " requires (Array, Array, Array)").c_str());
+		return false;
+	}
+
+	v8::Local<v8::Array> messages = info[0].As<v8::Array>();
+	v8::Local<v8::Array> signatures = info[1].As<v8::Array>();
+	v8::Local<v8::Array> publicKeys = info[2].As<v8::Array>();
+	size_t count = messages->Length();
+	if (signatures->Length() != count || publicKeys->Length() != count) {
+		Nan::ThrowError((prefix + " requires arrays of the same length").c_str());
+		return false;
+	}
+
+	items->messages.resize(count);
+	items->messageLens.resize(count);
+	items->signatures.resize(count);
+	items->publicKeys.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		v8::Local<v8::Value> message;
+		v8::Local<v8::Value> signature;
+		v8::Local<v8::Value> publicKey;
+		if (!Nan::Get(messages, i).ToLocal(&message) ||
+			!Buffer::HasInstance(message) ||
+			!Nan::Get(signatures, i).ToLocal(&signature) ||
+			!Buffer::HasInstance(signature) ||
+			Buffer::Length(signature) != 64 ||
+			!Nan::Get(publicKeys, i).ToLocal(&publicKey) ||
+			!Buffer::HasInstance(publicKey) ||
+			Buffer::Length(publicKey) != 32) {
+			Nan::ThrowError((prefix + " requires ([Buffer], [Buffer(64)], [Buffer(32)])").c_str());
+			return false;
+		}
+		items->messages[i] = (unsigned char*)Buffer::Data(message);
+		items->messageLens[i] = Buffer::Length(message);
+		items->signatures[i] = (unsigned char*)Buffer::Data(signature);
+		items->publicKeys[i] = (unsigned char*)Buffer::Data(publicKey);
+		if (!keep.IsEmpty()) {
+			Nan::Set(keep, 3 * i, message);
+			Nan::Set(keep, 3 * i + 1, signature);
+			Nan::Set(keep, 3 * i + 2, publicKey);
+		}
+	}
+	return true;
+}
+
+/**
+ * VerifyBatch(Array messages, Array signatures, Array publicKeys, Object options)
+ * messages: Buffers the signatures are for
+ * signatures: 64 byte Buffers, one per message
+ * publicKeys: 32 byte Buffers, one per message
+ * options.failFast: stop at the first invalid signature
+ * returns: { valid: boolean, bitmap: Buffer } where valid is true if every
+ *   signature is valid and bit i of bitmap is set if signature i is valid;
+ *   with failFast, { valid: boolean, firstInvalid: Number } instead, where
+ *   firstInvalid is the index of the first invalid signature or -1
+ **/
+NAN_METHOD(VerifyBatch) {
+	VerifyBatchItems items;
+	if (!GetVerifyBatchItems(info, "VerifyBatch", &items)) {
+		return;
+	}
+
+	bool failFast = false;
+	if (info.Length() > 3 && info[3]->IsObject()) {
+		v8::Local<v8::Value> option;
+		if (!Nan::Get(info[3].As<v8::Object>(), Nan::New("failFast").ToLocalChecked()).ToLocal(&option)) {
+			return;
+		}
+		failFast = Nan::To<bool>(option).FromJust();
+	}
+
+	size_t count = items.messages.size();
+	unsigned char random[32];
+	GetBatchRandom(random);
+	v8::Local<v8::Object> ret = Nan::New<Object>();
+	if (failFast) {
+		size_t first = crypto_sign_verify_batch_first_invalid(items.messages.data(), items.messageLens.data(), items.signatures.data(),
+		                                                      items.publicKeys.data(), count, random);
+		Nan::Set(ret, Nan::New("valid").ToLocalChecked(), Nan::New(first == count));
+		Nan::Set(ret, Nan::New("firstInvalid").ToLocalChecked(), Nan::New(first == count ? -1.0 : (double)first));
+	} else {
+		std::vector<unsigned char> valid(count);
+		int result = crypto_sign_verify_batch(items.messages.data(), items.messageLens.data(), items.signatures.data(),
+		                                      items.publicKeys.data(), count, random, valid.data());
+		Nan::Set(ret, Nan::New("valid").ToLocalChecked(), Nan::New(result == 0));
+		Nan::Set(ret, Nan::New("bitmap").ToLocalChecked(), NewBitmap(valid.data(), count));
+	}
+	info.GetReturnValue().Set(ret);
+}
+
+/**
+ * VerifyRecords(buffer)
+ * Verifies a run of packed records, each laid out as
+ *   [publicKey 32][signature 64][length u32 little endian][message length]
+ * The records are read in place and checked with batch verification, a
+ * chunk at a time, hashing the message bytes straight from buffer.
+ * buffer: any ArrayBufferView, ArrayBuffer or SharedArrayBuffer
+ * returns: a Buffer with bit i set if record i is valid, in the layout of
+ *   VerifyBatch's bitmap; throws RangeError if the last record is cut short
+ **/
+NAN_METHOD(VerifyRecords) {
+	unsigned char* data;
+	size_t length;
+	if (info.Length() < 1 || !GetBytes(info[0], &data, &length)) {
+		return Nan::ThrowError("VerifyRecords requires (ArrayBufferView or ArrayBuffer)");
+	}
+
+	VerifyBatchItems items;
+	size_t offset = 0;
+	while (offset < length) {
+		if (length - offset < 32 + 64 + 4) {
+			return Nan::ThrowRangeError("VerifyRecords found a truncated record header");
+		}
+		const unsigned char* record = data + offset;
+		size_t messageLen = (size_t)record[96] | (size_t)record[97] << 8 | (size_t)record[98] << 16 | (size_t)record[99] << 24;
+		if (messageLen > length - offset - 100) {
+			return Nan::ThrowRangeError("VerifyRecords found a record longer than the buffer");
+		}
+		items.publicKeys.push_back(record);
+		items.signatures.push_back(record + 32);
+		items.messageLens.push_back(messageLen);
+		items.messages.push_back(record + 100);
+		offset += 100 + messageLen;
+	}
+
+	// Chunks bound the work redone one by one when a batch has a bad record.
+	const size_t chunkSize = 1024;
+	size_t count = items.messages.size();
+	unsigned char random[32];
+	GetBatchRandom(random);
+	std::vector<unsigned char> valid(count);
+	for (size_t begin = 0; begin < count; begin += chunkSize) {
+		size_t n = count - begin < chunkSize ? count - begin : chunkSize;
+		crypto_sign_verify_batch(&items.messages[begin], &items.messageLens[begin], &items.signatures[begin],
+		                         &items.publicKeys[begin], n, random, &valid[begin]);
+	}
+	info.GetReturnValue().Set(NewBitmap(valid.data(), count));
+}
+
+/**
+ * Base for the *Async functions. The input Buffers are pinned with
+ * SaveToPersistent for the lifetime of the job, so Execute reads and writes
+ * their memory in place on the threadpool without copying anything.
+ * The callback gets (err, result); index.js wraps these in Promises.
+ **/
+class CryptoWorker : public Nan::AsyncWorker {
+public:
+	CryptoWorker(Nan::Callback *callback, const char *resourceName)
+		: Nan::AsyncWorker(callback, resourceName) {}
+
+protected:
+	virtual v8::Local<v8::Value> Result() = 0;
+
+	void HandleOKCallback() {
+		Nan::HandleScope scope;
+		v8::Local<v8::Value> argv[] = { Nan::Null(), Result() };
+		callback->Call(2, argv, async_resource);
+	}
+};
+
+class MakeKeypairWorker : public CryptoWorker {
+public:
+	MakeKeypairWorker(Nan::Callback *callback, v8::Local<v8::Object> publicKey, v8::Local<v8::Object> privateKey)
+		: CryptoWorker(callback, "ed25519:MakeKeypair") {
+		SaveToPersistent("publicKey", publicKey);
+		SaveToPersistent("privateKey", privateKey);
+		publicKeyData = (unsigned char*)Buffer::Data(publicKey);
+		privateKeyData = (unsigned char*)Buffer::Data(privateKey);
+	}
+
+	void Execute() {
+		crypto_sign_keypair(publicKeyData, privateKeyData);
+	}
+
+protected:
+	v8::Local<v8::Value> Result() {
+		v8::Local<v8::Object> result = Nan::New<Object>();
+		Nan::Set(result, Nan::New("publicKey").ToLocalChecked(), GetFromPersistent("publicKey"));
+		Nan::Set(result, Nan::New("privateKey").ToLocalChecked(), GetFromPersistent("privateKey"));
+		return result;
+	}
+
+private:
+	unsigned char* publicKeyData;
+	unsigned char* privateKeyData;
+};
+
+class SignWorker : public CryptoWorker {
+public:
+	SignWorker(Nan::Callback *callback, v8::Local<v8::Object> message, v8::Local<v8::Object> key, size_t keyLength, v8::Local<v8::Object> signature)
+		: CryptoWorker(callback, "ed25519:Sign") {
+		SaveToPersistent("message", message);
+		SaveToPersistent("signature", signature);
+		messageData = (unsigned char*)Buffer::Data(message);
+		messageLen = Buffer::Length(message);
+		signatureData = (unsigned char*)Buffer::Data(signature);
+		if (keyLength == 32) {
+			// A seed is small enough to copy; the keypair is derived in Execute.
+			memcpy(privateKeyData, Buffer::Data(key), 32);
+			privateKey = NULL;
+		} else {
+			SaveToPersistent("key", key);
+			privateKey = (unsigned char*)Buffer::Data(key);
+		}
+	}
+
+	void Execute() {
+		if (privateKey == NULL) {
+			unsigned char publicKeyData[32];
+			crypto_sign_keypair(publicKeyData, privateKeyData);
+			privateKey = privateKeyData;
+		}
+
+		crypto_sign_detached(signatureData, messageData, messageLen, privateKey);
+	}
+
+protected:
+	v8::Local<v8::Value> Result() {
+		return GetFromPersistent("signature");
+	}
+
+private:
+	const unsigned char* messageData;
+	size_t messageLen;
+	unsigned char* privateKey;
+	unsigned char privateKeyData[64];
+	unsigned char* signatureData;
+};
+
+class VerifyWorker : public CryptoWorker {
+public:
+	VerifyWorker(Nan::Callback *callback, v8::Local<v8::Object> message, v8::Local<v8::Object> signature, v8::Local<v8::Object> publicKey)
+		: CryptoWorker(callback, "ed25519:Verify") {
+		SaveToPersistent("message", message);
+		SaveToPersistent("signature", signature);
+		SaveToPersistent("publicKey", publicKey);
+		messageData = (unsigned char*)Buffer::Data(message);
+		messageLen = Buffer::Length(message);
+		signatureData = (unsigned char*)Buffer::Data(signature);
+		publicKeyData = (unsigned char*)Buffer::Data(publicKey);
+	}
+
+	void Execute() {
+		valid = VerifyWithCache(signatureData, messageData, messageLen, publicKeyData) == 0;
+	}
+
+protected:
+	v8::Local<v8::Value> Result() {
+		return Nan::New(valid);
+	}
+
+private:
+	const unsigned char* messageData;
+	size_t messageLen;
+	const unsigned char* signatureData;
+	const unsigned char* publicKeyData;
+	bool valid;
+};
+
+/**
+ * Base for the *BatchAsync functions. These run on the module's own thread
+ * pool (pool.h) rather than the libuv threadpool: the job is cut into
+ * Chunks() pieces that the pool threads share out, and each chunk gets the
+ * running thread's scratch memory. Inputs are pinned as for CryptoWorker.
+ **/
+/**
+ * BatchHandle, returned by the *BatchAsync functions. cancel() stops the
+ * job: chunks that have not started yet are skipped. index.js calls it
+ * when the AbortSignal passed in options.signal fires.
+ **/
+class BatchHandle : public Nan::ObjectWrap {
+public:
+	typedef std::shared_ptr<std::atomic<bool> > Flag;
+
+	static void Init() {
+		v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+		tpl->SetClassName(Nan::New("BatchHandle").ToLocalChecked());
+		tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		Nan::SetPrototypeMethod(tpl, "cancel", Cancel);
+		constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
+	}
+
+	static v8::Local<v8::Object> NewInstance(const Flag &cancelled) {
+		v8::Local<v8::Object> obj = Nan::NewInstance(Nan::New(constructor)).ToLocalChecked();
+		Nan::ObjectWrap::Unwrap<BatchHandle>(obj)->cancelled = cancelled;
+		return obj;
+	}
+
+private:
+	static NAN_METHOD(New) {
+		(new BatchHandle())->Wrap(info.This());
+		info.GetReturnValue().Set(info.This());
+	}
+
+	/**
+	 * cancel()
+	 * Skips every chunk of the job that has not started yet. Calling it
+	 * after the callback has run does nothing.
+	 **/
+	static NAN_METHOD(Cancel) {
+		BatchHandle *self = Nan::ObjectWrap::Unwrap<BatchHandle>(info.Holder());
+		if (self->cancelled) {
+			self->cancelled->store(true);
+		}
+	}
+
+	static Nan::Persistent<v8::Function> constructor;
+	Flag cancelled;
+};
+
+Nan::Persistent<v8::Function> BatchHandle::constructor;
+
+class PoolWorker : public CryptoWorker, public PoolJob {
+public:
+	PoolWorker(Nan::Callback *callback, const char *resourceName)
+		: CryptoWorker(callback, resourceName), cancelled(std::make_shared<std::atomic<bool> >(false)),
+		  stopped(false), hasDeadline(false) {}
+
+	void Execute() {}
+
+	void Complete() {
+		if (WasStopped() && !KeepsPartialResult()) {
+			SetErrorMessage("The operation was aborted");
+		}
+		WorkComplete();
+		Destroy();
+	}
+
+	/**
+	 * Reads options.deadline, a Date or a time in ms since the epoch as
+	 * given by Date.now(). Chunks that would start after it are skipped.
+	 * A job whose options.signal has already aborted runs no chunk at all.
+	 * name: the method, for the error message
+	 * returns: false with a JS exception pending if options or the deadline
+	 *          is not of a usable type, or if reading them threw
+	 **/
+	bool SetOptions(v8::Local<v8::Value> options, const char *name) {
+		if (options->IsUndefined() || options->IsNull()) {
+			return true;
+		}
+		if (!options->IsObject()) {
+			return BadDeadline(name);
+		}
+		v8::Local<v8::Value> signal;
+		if (!Nan::Get(options.As<v8::Object>(), Nan::New("signal").ToLocalChecked()).ToLocal(&signal)) {
+			return false;
+		}
+		if (signal->IsObject()) {
+			v8::Local<v8::Value> aborted;
+			if (!Nan::Get(signal.As<v8::Object>(), Nan::New("aborted").ToLocalChecked()).ToLocal(&aborted)) {
+				return false;
+			}
+			if (Nan::To<bool>(aborted).FromJust()) {
+				cancelled->store(true);
+			}
+		}
+		v8::Local<v8::Value> value;
+		if (!Nan::Get(options.As<v8::Object>(), Nan::New("deadline").ToLocalChecked()).ToLocal(&value)) {
+			return false;
+		}
+		if (value->IsUndefined()) {
+			return true;
+		}
+		double ms;
+		if (value->IsDate()) {
+			ms = value.As<v8::Date>()->ValueOf();
+		} else if (value->IsNumber()) {
+			ms = Nan::To<double>(value).FromJust();
+		} else {
+			return BadDeadline(name);
+		}
+		if (ms != ms) {
+			return BadDeadline(name);
+		}
+		double now = (double)std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		// Clamp so the conversion below cannot overflow for far off dates.
+		double left = ms - now;
+		left = left < -1e9 ? -1e9 : left > 1e12 ? 1e12 : left;
+		deadline = std::chrono::steady_clock::now() + std::chrono::microseconds((long long)(left * 1000));
+		hasDeadline = true;
+		return true;
+	}
+
+	/**
+	 * Submits the job to the pool.
+	 * returns: the BatchHandle that cancels it
+	 **/
+	v8::Local<v8::Object> Queue() {
+		v8::Local<v8::Object> handle = BatchHandle::NewInstance(cancelled);
+		PoolSubmit(Nan::GetCurrentEventLoop(), this);
+		return handle;
+	}
+
+protected:
+	/**
+	 * Checked by each chunk before it starts. Once it returns true the job
+	 * counts as stopped and every later chunk is skipped too.
+	 **/
+	bool Stopped() {
+		if (stopped) {
+			return true;
+		}
+		if (cancelled->load() || (hasDeadline && std::chrono::steady_clock::now() >= deadline)) {
+			stopped = true;
+		}
+		return stopped;
+	}
+
+	/**
+	 * true if some chunk was skipped. Unlike Stopped it does not look at
+	 * the clock, so it is safe to call from Result.
+	 **/
+	bool WasStopped() {
+		return stopped;
+	}
+
+	/**
+	 * Whether a stopped job still calls back with its result rather than
+	 * with an error.
+	 **/
+	virtual bool KeepsPartialResult() {
+		return false;
+	}
+
+private:
+	static bool BadDeadline(const char *name) {
+		Nan::ThrowError((std::string(name) + " options.deadline must be a Date or a Number").c_str());
+		return false;
+	}
+
+	BatchHandle::Flag cancelled;
+	std::atomic<bool> stopped;
+	bool hasDeadline;
+	std::chrono::steady_clock::time_point deadline;
+};
+
+/**
+ * Chunk length giving every pool thread about two chunks, so stealing can
+ * even out the load, while keeping each chunk in [min, max] items.
+ **/
+static size_t PoolChunkSize(size_t count, size_t min, size_t max) {
+	size_t pieces = 2 * (size_t)PoolThreads();
+	size_t size = (count + pieces - 1) / pieces;
+	return size < min ? min : size > max ? max : size;
+}
+
+class VerifyBatchWorker : public PoolWorker {
+public:
+	VerifyBatchWorker(Nan::Callback *callback, VerifyBatchItems *items, v8::Local<v8::Array> keep)
+		: PoolWorker(callback, "ed25519:VerifyBatch"), valid(items->messages.size()), decided(items->messages.size()) {
+		SaveToPersistent("buffers", keep);
+		this->items.messages.swap(items->messages);
+		this->items.messageLens.swap(items->messageLens);
+		this->items.signatures.swap(items->signatures);
+		this->items.publicKeys.swap(items->publicKeys);
+		count = valid.size();
+		chunkSize = PoolChunkSize(count, 64, 1024);
+		// Every chunk may share the seed: the coefficients are hashed
+		// together with the chunk's own items.
+		GetBatchRandom(random);
+	}
+
+	size_t Chunks() {
+		return (count + chunkSize - 1) / chunkSize;
+	}
+
+	void RunChunk(size_t chunk, PoolScratch *scratch) {
+		if (Stopped()) {
+			return;
+		}
+		size_t begin = chunk * chunkSize;
+		size_t n = count - begin < chunkSize ? count - begin : chunkSize;
+		void *memory = scratch->Get(crypto_sign_verify_batch_scratch_bytes(n));
+		if (memory != NULL) {
+			crypto_sign_verify_batch_scratch(&items.messages[begin], &items.messageLens[begin], &items.signatures[begin],
+			                                 &items.publicKeys[begin], n, random, &valid[begin], memory);
+		} else {
+			crypto_sign_verify_batch(&items.messages[begin], &items.messageLens[begin], &items.signatures[begin],
+			                         &items.publicKeys[begin], n, random, &valid[begin]);
+		}
+		memset(&decided[begin], 1, n);
+	}
+
+protected:
+	/**
+	 * A stopped job still reports the items its finished chunks decided:
+	 * { valid: false, bitmap, decided, aborted: true }, where decided has
+	 * a bit set for every item that was checked.
+	 **/
+	v8::Local<v8::Value> Result() {
+		bool all = true;
+		for (size_t i = 0; i < count; i++) {
+			all = all && valid[i] == 1;
+		}
+		v8::Local<v8::Object> result = Nan::New<Object>();
+		Nan::Set(result, Nan::New("valid").ToLocalChecked(), Nan::New(all && !WasStopped()));
+		Nan::Set(result, Nan::New("bitmap").ToLocalChecked(), NewBitmap(valid.data(), count));
+		if (WasStopped()) {
+			Nan::Set(result, Nan::New("decided").ToLocalChecked(), NewBitmap(decided.data(), count));
+			Nan::Set(result, Nan::New("aborted").ToLocalChecked(), Nan::True());
+		}
+		return result;
+	}
+
+	bool KeepsPartialResult() {
+		return true;
+	}
+
+private:
+	VerifyBatchItems items;
+	std::vector<unsigned char> valid;
+	std::vector<unsigned char> decided;
+	size_t count;
+	size_t chunkSize;
+	unsigned char random[32];
+};
+
+class SignBatchWorker : public PoolWorker {
+public:
+	SignBatchWorker(Nan::Callback *callback, std::vector<const unsigned char*> *messages, std::vector<size_t> *messageLens,
+	                v8::Local<v8::Array> keep, const unsigned char *privateKey, v8::Local<v8::Object> signatures)
+		: PoolWorker(callback, "ed25519:SignBatch") {
+		SaveToPersistent("buffers", keep);
+		SaveToPersistent("signatures", signatures);
+		messageData.swap(*messages);
+		messageLen.swap(*messageLens);
+		memcpy(privateKeyData, privateKey, 64);
+		signatureData = (unsigned char*)Buffer::Data(signatures);
+		count = messageData.size();
+		// crypto_sign_batch works four messages at a time.
+		chunkSize = (PoolChunkSize(count, 16, 256) + 3) & ~(size_t)3;
+	}
+
+	~SignBatchWorker() {
+		memset(privateKeyData, 0, sizeof(privateKeyData));
+	}
+
+	size_t Chunks() {
+		return (count + chunkSize - 1) / chunkSize;
+	}
+
+	void RunChunk(size_t chunk, PoolScratch *scratch) {
+		if (Stopped()) {
+			return;
+		}
+		size_t begin = chunk * chunkSize;
+		size_t n = count - begin < chunkSize ? count - begin : chunkSize;
+		crypto_sign_batch(signatureData + 64 * begin, &messageData[begin], &messageLen[begin], n, privateKeyData);
+	}
+
+protected:
+	v8::Local<v8::Value> Result() {
+		return GetFromPersistent("signatures");
+	}
+
+private:
+	std::vector<const unsigned char*> messageData;
+	std::vector<size_t> messageLen;
+	unsigned char privateKeyData[64];
+	unsigned char* signatureData;
+	size_t count;
+	size_t chunkSize;
+};
+
+class MakeKeypairBatchWorker : public PoolWorker {
+public:
+	MakeKeypairBatchWorker(Nan::Callback *callback, v8::Local<v8::Object> publicKeys, v8::Local<v8::Object> privateKeys)
+		: PoolWorker(callback, "ed25519:MakeKeypairBatch") {
+		SaveToPersistent("publicKeys", publicKeys);
+		SaveToPersistent("privateKeys", privateKeys);
+		publicKeyData = (unsigned char*)Buffer::Data(publicKeys);
+		privateKeyData = (unsigned char*)Buffer::Data(privateKeys);
+		count = Buffer::Length(publicKeys) / 32;
+		// crypto_sign_keypair_batch shares one inversion per 64 keys.
+		chunkSize = (PoolChunkSize(count, 64, 1024) + 63) & ~(size_t)63;
+	}
+
+	size_t Chunks() {
+		return (count + chunkSize - 1) / chunkSize;
+	}
+
+	void RunChunk(size_t chunk, PoolScratch *scratch) {
+		if (Stopped()) {
+			return;
+		}
+		size_t begin = chunk * chunkSize;
+		size_t n = count - begin < chunkSize ? count - begin : chunkSize;
+		crypto_sign_keypair_batch(publicKeyData + 32 * begin, privateKeyData + 64 * begin, n);
+	}
+
+protected:
+	v8::Local<v8::Value> Result() {
+		v8::Local<v8::Object> result = Nan::New<Object>();
+		Nan::Set(result, Nan::New("publicKeys").ToLocalChecked(), GetFromPersistent("publicKeys"));
+		Nan::Set(result, Nan::New("privateKeys").ToLocalChecked(), GetFromPersistent("privateKeys"));
+		return result;
+	}
+
+private:
+	unsigned char* publicKeyData;
+	unsigned char* privateKeyData;
+	size_t count;
+	size_t chunkSize;
+};
+
+/**
+ * Base for SignFile and VerifyFile. The file is read on the threadpool
+ * through one 64 KB buffer, so no file data reaches the V8 heap. Files are
+ * not memory mapped: one truncated while mapped would kill the process
+ * with SIGBUS, and hashing costs far more than the copy a read makes.
+ **/
+class FileWorker : public CryptoWorker {
+public:
+	FileWorker(Nan::Callback *callback, const char *resourceName, v8::Local<v8::Value> path)
+		: CryptoWorker(callback, resourceName), path(*Nan::Utf8String(path)), fd(-1) {}
+
+	~FileWorker() {
+		if (fd >= 0) {
+			uv_fs_t req;
+			uv_fs_close(NULL, &req, fd, NULL);
+			uv_fs_req_cleanup(&req);
+		}
+	}
+
+protected:
+	/**
+	 * Opens the file.
+	 * returns: false with the error message set if the file cannot be opened
+	 **/
+	bool Open() {
+		uv_fs_t req;
+		int result = uv_fs_open(NULL, &req, path.c_str(), UV_FS_O_RDONLY, 0, NULL);
+		uv_fs_req_cleanup(&req);
+		if (result < 0) {
+			return Fail(result, "open");
+		}
+		fd = result;
+		return true;
+	}
+
+	/**
+	 * Passes the whole file to update(data, length), in pieces.
+	 * fromStart: read from offset 0 instead of the current position, so the
+	 *            file can be read again; fails on pipes
+	 * returns: false with the error message set if a read failed
+	 **/
+	template <typename F>
+	bool Read(F update, bool fromStart) {
+		if (buffer.empty()) {
+			buffer.resize(65536);
+		}
+		int64_t offset = 0;
+		for (;;) {
+			uv_fs_t req;
+			uv_buf_t buf = uv_buf_init((char*)buffer.data(), (unsigned int)buffer.size());
+			int result = uv_fs_read(NULL, &req, fd, &buf, 1, fromStart ? offset : -1, NULL);
+			uv_fs_req_cleanup(&req);
+			if (result < 0) {
+				return Fail(result, "read");
+			}
+			if (result == 0) {
+				return true;
+			}
+			update(buffer.data(), (size_t)result);
+			offset += result;
+		}
+	}
+
+	bool Fail(int error, const char *syscall) {
+		std::string message = std::string(uv_err_name(error)) + ": " + uv_strerror(error) + ", " + syscall + " '" + path + "'";
+		SetErrorMessage(message.c_str());
+		return false;
+	}
+
+private:
+	std::string path;
+	int fd;
+	std::vector<unsigned char> buffer;
+};
+
+class SignFileWorker : public FileWorker {
+public:
+	SignFileWorker(Nan::Callback *callback, v8::Local<v8::Value> path, v8::Local<v8::Object> key, size_t keyLength, v8::Local<v8::Object> signature)
+		: FileWorker(callback, "ed25519:SignFile", path) {
+		SaveToPersistent("signature", signature);
+		signatureData = (unsigned char*)Buffer::Data(signature);
+		memcpy(privateKeyData, Buffer::Data(key), keyLength);
+		seed = keyLength == 32;
+	}
+
+	~SignFileWorker() {
+		memset(privateKeyData, 0, 64);
+	}
+
+	void Execute() {
+		if (seed) {
+			crypto_sign_keypair(privateKeyData + 32, privateKeyData);
+		}
+		if (!Open()) {
+			return;
+		}
+		crypto_sign_signer *signer = crypto_sign_signer_new(privateKeyData);
+		if (signer == NULL) {
+			return SetErrorMessage("SignFile could not allocate memory");
+		}
+		auto update = [signer](const unsigned char *data, size_t length) {
+			crypto_sign_signer_update(signer, data, length);
+		};
+		if (Read(update, true)) {
+			crypto_sign_signer_rewind(signer);
+			if (Read(update, true) && crypto_sign_signer_final(signer, signatureData) != 0) {
+				SetErrorMessage("SignFile: the file changed while it was being signed");
+			}
+		}
+		crypto_sign_signer_free(signer);
+	}
+
+protected:
+	v8::Local<v8::Value> Result() {
+		return GetFromPersistent("signature");
+	}
+
+private:
+	unsigned char privateKeyData[64];
+	bool seed;
+	unsigned char* signatureData;
+};
+
+class VerifyFileWorker : public FileWorker {
+public:
+	VerifyFileWorker(Nan::Callback *callback, v8::Local<v8::Value> path, v8::Local<v8::Object> signature, v8::Local<v8::Object> publicKey)
+		: FileWorker(callback, "ed25519:VerifyFile", path) {
+		memcpy(signatureData, Buffer::Data(signature), 64);
+		memcpy(publicKeyData, Buffer::Data(publicKey), 32);
+	}
+
+	void Execute() {
+		if (!Open()) {
+			return;
+		}
+		crypto_sign_verifier *verifier = crypto_sign_verifier_new(signatureData, publicKeyData);
+		if (verifier == NULL) {
+			return SetErrorMessage("VerifyFile could not allocate memory");
+		}
+		auto update = [verifier](const unsigned char *data, size_t length) {
+			crypto_sign_verifier_update(verifier, data, length);
+		};
+		if (Read(update, false)) {
+			valid = crypto_sign_verifier_final(verifier) == 0;
+		}
+		crypto_sign_verifier_free(verifier);
+	}
+
+protected:
+	v8::Local<v8::Value> Result() {
+		return Nan::New(valid);
+	}
+
+private:
+	unsigned char signatureData[64];
+	unsigned char publicKeyData[32];
+	bool valid;
+};
+
+/**
+ * MakeKeypairAsync(Buffer seed, Function callback)
+ * Same as MakeKeypair, computed on the libuv threadpool.
+ * callback: called with (err, keyPair)
+ **/
+NAN_METHOD(MakeKeypairAsync) {
+	v8::Local<v8::Object> seed;
+	if (info.Length() < 2 ||
+		!GetBuffer(info[0], &seed, 32) ||
+		!info[1]->IsFunction()) {
+		return Nan::ThrowError("MakeKeypairAsync requires (Buffer(32), Function)");
+	}
+
+	v8::Local<v8::Object> privateKey = Nan::NewBuffer(64).ToLocalChecked();
+	v8::Local<v8::Object> publicKey = Nan::NewBuffer(32).ToLocalChecked();
+	memcpy(Buffer::Data(privateKey), Buffer::Data(seed), 32);
+
+	Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+	Nan::AsyncQueueWorker(new MakeKeypairWorker(callback, publicKey, privateKey));
+}
+
+/**
+ * SignAsync(Buffer message, {Buffer seed | Buffer privateKey | Object keyPair}, Function callback)
+ * Same as Sign, computed on the libuv threadpool.
+ * callback: called with (err, signature)
+ **/
+NAN_METHOD(SignAsync) {
+	v8::Local<v8::Object> message;
+	v8::Local<v8::Object> key;
+	size_t keyLength = 0;
+	if (info.Length() < 3 ||
+		!GetBuffer(info[0], &message) ||
+		(keyLength = GetSigningKey(info[1], &key)) == 0 ||
+		!info[2]->IsFunction()) {
+		return Nan::ThrowError("SignAsync requires (Buffer, {Buffer(32 or 64) | keyPair object}, Function)");
+	}
+
+	v8::Local<v8::Object> signature = Nan::NewBuffer(64).ToLocalChecked();
+	Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
+	Nan::AsyncQueueWorker(new SignWorker(callback, message, key, keyLength, signature));
+}
+
+/**
+ * VerifyAsync(Buffer message, Buffer signature, Buffer publicKey, Function callback)
+ * Same as Verify, computed on the libuv threadpool.
+ * callback: called with (err, boolean)
+ **/
+NAN_METHOD(VerifyAsync) {
+	v8::Local<v8::Object> message;
+	v8::Local<v8::Object> signature;
+	v8::Local<v8::Object> publicKey;
+	if (info.Length() < 4 ||
+		!GetBuffer(info[0], &message) ||
+		!GetBuffer(info[1], &signature, 64) ||
+		!GetBuffer(info[2], &publicKey, 32) ||
+		!info[3]->IsFunction()) {
+		return Nan::ThrowError("VerifyAsync requires (Buffer, Buffer(64), Buffer(32), Function)");
+	}
+
+	Nan::Callback *callback = new Nan::Callback(info[3].As<v8::Function>());
+	Nan::AsyncQueueWorker(new VerifyWorker(callback, message, signature, publicKey));
+}
+
+/**
+ * SignFile(String path, {Buffer seed | Buffer privateKey | Object keyPair}, Function callback)
+ * Signs the contents of the file at path on the libuv threadpool. The file
+ * is read twice, so it must be seekable; the signature is refused if it
+ * changes between the two reads.
+ * callback: called with (err, signature)
+ **/
+NAN_METHOD(SignFile) {
+	v8::Local<v8::Object> key;
+	size_t keyLength = 0;
+	if (info.Length() < 3 ||
+		!info[0]->IsString() ||
+		(keyLength = GetSigningKey(info[1], &key)) == 0 ||
+		!info[2]->IsFunction()) {
+		return Nan::ThrowError("SignFile requires (String, {Buffer(32 or 64) | keyPair object}, Function)");
+	}
+
+	v8::Local<v8::Object> signature = Nan::NewBuffer(64).ToLocalChecked();
+	Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
+	Nan::AsyncQueueWorker(new SignFileWorker(callback, info[0], key, keyLength, signature));
+}
+
+/**
+ * VerifyFile(String path, Buffer signature, Buffer publicKey, Function callback)
+ * Verifies signature over the contents of the file at path on the libuv
+ * threadpool. Pipes and other unseekable files are read once, in chunks.
+ * callback: called with (err, valid)
+ **/
+NAN_METHOD(VerifyFile) {
+	v8::Local<v8::Object> signature;
+	v8::Local<v8::Object> publicKey;
+	if (info.Length() < 4 ||
+		!info[0]->IsString() ||
+		!GetBuffer(info[1], &signature, 64) ||
+		!GetBuffer(info[2], &publicKey, 32) ||
+		!info[3]->IsFunction()) {
+		return Nan::ThrowError("VerifyFile requires (String, Buffer(64), Buffer(32), Function)");
+	}
+
+	Nan::Callback *callback = new Nan::Callback(info[3].As<v8::Function>());
+	Nan::AsyncQueueWorker(new VerifyFileWorker(callback, info[0], signature, publicKey));
+}
+
+/**
+ * Reads the trailing ([Object options,] Function callback) arguments of a
+ * *BatchAsync function, starting at index.
+ * returns: false if the callback is missing
+ **/
+static bool GetPoolArgs(const Nan::FunctionCallbackInfo<v8::Value> &info, int index, v8::Local<v8::Value> *options, v8::Local<v8::Function> *callback) {
+	*options = Nan::Undefined();
+	if (info.Length() > index + 1 && !info[index]->IsFunction()) {
+		*options = info[index++];
+	}
+	if (info.Length() <= index || !info[index]->IsFunction()) {
+		return false;
+	}
+	*callback = info[index].As<v8::Function>();
+	return true;
+}
+
+/**
+ * VerifyBatchAsync(Array messages, Array signatures, Array publicKeys, [Object options,] Function callback)
+ * Same as VerifyBatch, split across the threads of the batch pool.
+ * options.deadline: Date or ms since the epoch; chunks that have not
+ *   started by then are skipped
+ * callback: called with (err, { valid, bitmap }). If the job was cancelled
+ *   or ran past its deadline: (null, { valid: false, bitmap, decided,
+ *   aborted: true }), decided marking the items that were checked
+ * returns: a BatchHandle whose cancel() skips the chunks not yet started
+ **/
+NAN_METHOD(VerifyBatchAsync) {
+	VerifyBatchItems items;
+	v8::Local<v8::Array> keep = Nan::New<v8::Array>();
+	if (!GetVerifyBatchItems(info, "VerifyBatchAsync", &items, keep)) {
+		return;
+	}
+	v8::Local<v8::Value> options;
+	v8::Local<v8::Function> callback;
+	if (!GetPoolArgs(info, 3, &options, &callback)) {
+		return Nan::ThrowError("VerifyBatchAsync requires (Array, Array, Array, [Object,] Function)");
+	}
+
+	VerifyBatchWorker *worker = new VerifyBatchWorker(new Nan::Callback(callback), &items, keep);
+	if (!worker->SetOptions(options, "VerifyBatchAsync")) {
+		delete worker;
+		return;
+	}
+	info.GetReturnValue().Set(worker->Queue());
+}
+
+/**
+ * SignBatchAsync(Array messages, {Buffer seed | Buffer privateKey | Object keyPair}, [Object options,] Function callback)
+ * Same as SignBatch, split across the threads of the batch pool.
+ * options.deadline: as for VerifyBatchAsync
+ * callback: called with (err, signatures). A cancelled job, or one that
+ *   ran past its deadline, gives an error instead.
+ * returns: a BatchHandle
+ **/
+NAN_METHOD(SignBatchAsync) {
+	v8::Local<v8::Object> keyObj;
+	size_t keyLength = 0;
+	std::vector<const unsigned char*> messageData;
+	std::vector<size_t> messageLen;
+	v8::Local<v8::Array> keep = Nan::New<v8::Array>();
+	v8::Local<v8::Value> options;
+	v8::Local<v8::Function> callback;
+	if (info.Length() < 3 ||
+		!info[0]->IsArray() ||
+		(keyLength = GetSigningKey(info[1], &keyObj)) == 0 ||
+		!GetPoolArgs(info, 2, &options, &callback) ||
+		!GetMessages(info[0].As<v8::Array>(), &messageData, &messageLen, keep)) {
+		return Nan::ThrowError("SignBatchAsync requires ([Buffer], {Buffer(32 or 64) | keyPair object}, [Object,] Function)");
+	}
+
+	unsigned char privateKeyData[64];
+	memcpy(privateKeyData, Buffer::Data(keyObj), keyLength);
+	if (keyLength == 32) {
+		unsigned char publicKeyData[32];
+		crypto_sign_keypair(publicKeyData, privateKeyData);
+	}
+
+	v8::Local<v8::Object> signatures = Nan::NewBuffer(64 * messageData.size()).ToLocalChecked();
+	SignBatchWorker *worker = new SignBatchWorker(new Nan::Callback(callback), &messageData, &messageLen, keep, privateKeyData, signatures);
+	memset(privateKeyData, 0, sizeof(privateKeyData));
+	if (!worker->SetOptions(options, "SignBatchAsync")) {
+		delete worker;
+		return;
+	}
+	info.GetReturnValue().Set(worker->Queue());
+}
+
+/**
+ * MakeKeypairBatchAsync(Buffer seeds, [Object options,] Function callback)
+ * Derives one keypair per 32 byte seed in seeds, split across the threads
+ * of the batch pool.
+ * options.deadline: as for VerifyBatchAsync
+ * callback: called with (err, { publicKeys, privateKeys }), Buffers holding
+ *   key i at offset 32 * i and 64 * i. A cancelled job, or one that ran
+ *   past its deadline, gives an error instead.
+ * returns: a BatchHandle
+ **/
+NAN_METHOD(MakeKeypairBatchAsync) {
+	v8::Local<v8::Object> seeds;
+	v8::Local<v8::Value> options;
+	v8::Local<v8::Function> callback;
+	if (info.Length() < 2 ||
+		!GetBuffer(info[0], &seeds) ||
+		Buffer::Length(seeds) % 32 != 0 ||
+		!GetPoolArgs(info, 1, &options, &callback)) {
+		return Nan::ThrowError("MakeKeypairBatchAsync requires (Buffer(32 * n), [Object,] Function)");
+	}
+
+	size_t count = Buffer::Length(seeds) / 32;
+	v8::Local<v8::Object> publicKeys = Nan::NewBuffer(32 * count).ToLocalChecked();
+	v8::Local<v8::Object> privateKeys = Nan::NewBuffer(64 * count).ToLocalChecked();
+	for (size_t i = 0; i < count; i++) {
+		memcpy(Buffer::Data(privateKeys) + 64 * i, Buffer::Data(seeds) + 32 * i, 32);
+	}
+
+	MakeKeypairBatchWorker *worker = new MakeKeypairBatchWorker(new Nan::Callback(callback), publicKeys, privateKeys);
+	if (!worker->SetOptions(options, "MakeKeypairBatchAsync")) {
+		delete worker;
+		return;
+	}
+	info.GetReturnValue().Set(worker->Queue());
+}
+
+/**
+ * ConfigurePool(Object options)
+ * Sets up and starts the thread pool used by the *BatchAsync functions.
+ * Throws if the pool is already running, i.e. after an earlier
+ * ConfigurePool or *BatchAsync call.
+ * The ED25519_POOL_THREADS and ED25519_POOL_PIN environment variables set
+ * the same options when ConfigurePool is not called.
+ * options.threads: number of threads, default one per CPU
+ * options.pin: bind each thread to its own CPU (Linux and Windows only)
+ * returns: the number of pool threads
+ **/
+NAN_METHOD(ConfigurePool) {
+	if (info.Length() < 1 || !info[0]->IsObject()) {
+		return Nan::ThrowError("ConfigurePool requires ({ threads: Number, pin: Boolean })");
+	}
+
+	v8::Local<v8::Object> options = info[0].As<v8::Object>();
+	v8::Local<v8::Value> threads = Nan::Get(options, Nan::New("threads").ToLocalChecked()).ToLocalChecked();
+	v8::Local<v8::Value> pin = Nan::Get(options, Nan::New("pin").ToLocalChecked()).ToLocalChecked();
+	if (!threads->IsUndefined() && (!threads->IsUint32() || Nan::To<uint32_t>(threads).FromJust() > 256)) {
+		return Nan::ThrowRangeError("ConfigurePool threads must be an integer from 0 to 256");
+	}
+
+	if (!PoolConfigure(threads->IsUndefined() ? 0 : Nan::To<uint32_t>(threads).FromJust(), Nan::To<bool>(pin).FromJust())) {
+		return Nan::ThrowError("ConfigurePool must be called before the pool is first used");
+	}
+	info.GetReturnValue().Set(Nan::New(PoolThreads()));
+}
+
+/**
+ * GetBackend()
+ * The signature code is built for several field representations and the
+ * fastest one the CPU supports is picked when the module loads. The
+ * ED25519_BACKEND environment variable forces one of the available names;
+ * a name that is not available is ignored.
+ * returns: an Object with the backend's name, the field representation,
+ * the kernels used for field multiplication, 4-way base multiplication,
+ * the double scalar multiplication of Verify, field inversion and SHA-512,
+ * and the names available on this build and CPU
+ **/
+NAN_METHOD(GetBackend) {
+	crypto_sign_backend_info backend;
+	crypto_sign_backend_get_info(&backend);
+
+	v8::Local<v8::Array> available = Nan::New<v8::Array>();
+	for (size_t i = 0; crypto_sign_backend_available(i) != NULL; i++) {
+		Nan::Set(available, (uint32_t)i, Nan::New(crypto_sign_backend_available(i)).ToLocalChecked());
+	}
+
+	v8::Local<v8::Object> result = Nan::New<Object>();
+	Nan::Set(result, Nan::New("name").ToLocalChecked(), Nan::New(backend.name).ToLocalChecked());
+	Nan::Set(result, Nan::New("field").ToLocalChecked(), Nan::New(backend.field).ToLocalChecked());
+	Nan::Set(result, Nan::New("fieldMul").ToLocalChecked(), Nan::New(backend.field_mul).ToLocalChecked());
+	Nan::Set(result, Nan::New("baseMulX4").ToLocalChecked(), Nan::New(backend.base_x4).ToLocalChecked());
+	Nan::Set(result, Nan::New("doubleScalarMul").ToLocalChecked(), Nan::New(backend.double_scalarmult).ToLocalChecked());
+	Nan::Set(result, Nan::New("invert").ToLocalChecked(), Nan::New(backend.invert).ToLocalChecked());
+	Nan::Set(result, Nan::New("sha512").ToLocalChecked(), Nan::New(backend.sha512).ToLocalChecked());
+	Nan::Set(result, Nan::New("available").ToLocalChecked(), available);
+	info.GetReturnValue().Set(result);
+}
 
 void InitModule(v8::Local<v8::Object> exports) {
+	crypto_sign_backend_select(getenv("ED25519_BACKEND"));
 	Nan::SetMethod(exports, "MakeKeypair", MakeKeypair);
+	Nan::SetMethod(exports, "MakeKeypairInto", MakeKeypairInto);
+	Nan::SetMethod(exports, "MakeKeypairBatch", MakeKeypairBatch);
 	Nan::SetMethod(exports, "Sign", Sign);
+	Nan::SetMethod(exports, "SignInto", SignInto);
+	Nan::SetMethod(exports, "SignAt", SignAt);
+	Nan::SetMethod(exports, "SignBatch", SignBatch);
+	SigningKey::Init(exports);
+	Nan::SetMethod(exports, "CreateSigner", CreateSigner);
+	Signer::Init();
 	Nan::SetMethod(exports, "Verify", Verify);
+	Nan::SetMethod(exports, "VerifyAt", VerifyAt);
+	Nan::SetMethod(exports, "VerifyBatch", VerifyBatch);
+	Nan::SetMethod(exports, "VerifyRecords", VerifyRecords);
+	Nan::SetMethod(exports, "CreateVerifier", CreateVerifier);
+	Verifier::Init();
+	Nan::SetMethod(exports, "SetVerifyCacheSize", SetVerifyCacheSize);
+	Nan::SetMethod(exports, "GetVerifyCacheStats", GetVerifyCacheStats);
+	VerifyingKey::Init(exports);
+	Nan::SetMethod(exports, "MakeKeypairAsync", MakeKeypairAsync);
+	Nan::SetMethod(exports, "SignAsync", SignAsync);
+	Nan::SetMethod(exports, "VerifyAsync", VerifyAsync);
+	Nan::SetMethod(exports, "SignFile", SignFile);
+	Nan::SetMethod(exports, "VerifyFile", VerifyFile);
+	BatchHandle::Init();
+	Nan::SetMethod(exports, "VerifyBatchAsync", VerifyBatchAsync);
+	Nan::SetMethod(exports, "SignBatchAsync", SignBatchAsync);
+	Nan::SetMethod(exports, "MakeKeypairBatchAsync", MakeKeypairBatchAsync);
+	Nan::SetMethod(exports, "ConfigurePool", ConfigurePool);
+	Nan::SetMethod(exports, "GetBackend", GetBackend);
 }
 
 NODE_MODULE(ed25519, InitModule)
@@ -0,0 +1,32 @@
+#include "backend.h"
+#include "dispatch.h"
+
+const crypto_sign_backend crypto_sign_backend_table = {
+  ED25519_FIELD,
+  crypto_sign_keypair,
+  crypto_sign_keypair_batch,
+  crypto_sign_open,
+  crypto_sign,
+  crypto_sign_detached,
+  crypto_sign_expand,
+  crypto_sign_detached_expanded,
+  crypto_sign_signer_new,
+  crypto_sign_signer_update,
+  crypto_sign_signer_rewind,
+  crypto_sign_signer_final,
+  crypto_sign_signer_free,
+  crypto_sign_batch,
+  crypto_sign_verify,
+  crypto_sign_verifying_key_new,
+  crypto_sign_verifying_key_free,
+  crypto_sign_verify_with_key,
+  crypto_sign_verifier_new,
+  crypto_sign_verifier_update,
+  crypto_sign_verifier_final,
+  crypto_sign_verifier_free,
+  crypto_sign_verify_batch,
+  crypto_sign_verify_batch_scratch_bytes,
+  crypto_sign_verify_batch_scratch,
+  crypto_sign_verify_batch_first_invalid,
+  crypto_sign_verify_batch_first_invalid_scratch
+};
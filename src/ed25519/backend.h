@@ -0,0 +1,55 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+/*
+The group and signature code is compiled once for each field
+representation and the copies are linked side by side. Every symbol that
+depends on the representation is named through ED25519_NAME, giving
+crypto_sign_ed25519_ref10_*, crypto_sign_ed25519_fe51_* and
+crypto_sign_ed25519_fe64_*. dispatch.c picks one copy at run time and
+provides the public crypto_sign_* functions.
+
+Include this first in files that define the public functions.
+*/
+
+#if defined(ED25519_FE64)
+#define ED25519_NAME(name) crypto_sign_ed25519_fe64_##name
+#define ED25519_FIELD "fe64"
+#elif defined(ED25519_FE51)
+#define ED25519_NAME(name) crypto_sign_ed25519_fe51_##name
+#define ED25519_FIELD "fe51"
+#else
+#define ED25519_NAME(name) crypto_sign_ed25519_ref10_##name
+#define ED25519_FIELD "ref10"
+#endif
+
+#define crypto_sign_backend_table ED25519_NAME(backend)
+
+#define crypto_sign_keypair ED25519_NAME(keypair)
+#define crypto_sign_keypair_batch ED25519_NAME(keypair_batch)
+#define crypto_sign_open ED25519_NAME(open)
+#define crypto_sign ED25519_NAME(sign)
+#define crypto_sign_detached ED25519_NAME(detached)
+#define crypto_sign_expand ED25519_NAME(expand)
+#define crypto_sign_detached_expanded ED25519_NAME(detached_expanded)
+#define crypto_sign_signer_new ED25519_NAME(signer_new)
+#define crypto_sign_signer_update ED25519_NAME(signer_update)
+#define crypto_sign_signer_rewind ED25519_NAME(signer_rewind)
+#define crypto_sign_signer_final ED25519_NAME(signer_final)
+#define crypto_sign_signer_free ED25519_NAME(signer_free)
+#define crypto_sign_batch ED25519_NAME(batch)
+#define crypto_sign_verify ED25519_NAME(verify)
+#define crypto_sign_verifying_key_new ED25519_NAME(verifying_key_new)
+#define crypto_sign_verifying_key_free ED25519_NAME(verifying_key_free)
+#define crypto_sign_verify_with_key ED25519_NAME(verify_with_key)
+#define crypto_sign_verifier_new ED25519_NAME(verifier_new)
+#define crypto_sign_verifier_update ED25519_NAME(verifier_update)
+#define crypto_sign_verifier_final ED25519_NAME(verifier_final)
+#define crypto_sign_verifier_free ED25519_NAME(verifier_free)
+#define crypto_sign_verify_batch ED25519_NAME(verify_batch)
+#define crypto_sign_verify_batch_scratch_bytes ED25519_NAME(verify_batch_scratch_bytes)
+#define crypto_sign_verify_batch_scratch ED25519_NAME(verify_batch_scratch)
+#define crypto_sign_verify_batch_first_invalid ED25519_NAME(verify_batch_first_invalid)
+#define crypto_sign_verify_batch_first_invalid_scratch ED25519_NAME(verify_batch_first_invalid_scratch)
+
+#endif
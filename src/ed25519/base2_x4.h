@@ -0,0 +1,96 @@
+ {
+  { 25967493,-12545711,2,-8738181 },
+  { -14356035,934262,0,4489570 },
+  { 29566456,-2722910,0,9688441 },
+  { 3660896,3049990,0,-14785194 },
+  { -12694345,-727428,0,10184609 },
+  { 4014787,9406986,0,-12363380 },
+  { 27544626,12720692,0,29287919 },
+  { -11754271,5043384,0,11864899 },
+  { -6079156,19500929,0,-24514362 },
+  { 2047605,-15469378,0,-4438546 },
+ },
+ {
+  { 15636291,16568933,2,30464156 },
+  { -9688557,4717097,0,-5976125 },
+  { 24204773,-11556148,0,-11779434 },
+  { -7912398,-1102322,0,-15670865 },
+  { 616977,15682896,0,23220365 },
+  { -16685262,-11807043,0,15915852 },
+  { 27787600,16354577,0,7512774 },
+  { -14772189,-11775962,0,10017326 },
+  { 28944400,7689662,0,-17749093 },
+  { -1550024,11199574,0,-9920357 },
+ },
+ {
+  { 10861363,4708026,2,19563160 },
+  { 11473154,6336745,0,16186464 },
+  { 27284546,20377586,0,-29386857 },
+  { 1981175,9066809,0,4097519 },
+  { -30064349,-11272109,0,10237984 },
+  { 12577861,6594696,0,-4348115 },
+  { 32867885,-25653668,0,28542350 },
+  { 14515107,12483688,0,13850243 },
+  { -15438304,-12668491,0,-23678021 },
+  { 10819380,5581306,0,-15815942 },
+ },
+ {
+  { 5153746,-30269007,2,28881845 },
+  { 9909285,-3463509,0,14381568 },
+  { 1723747,7665486,0,9657904 },
+  { -2777874,10083793,0,3680757 },
+  { 30523605,28475525,0,-20181635 },
+  { 5516873,1649722,0,7843316 },
+  { 19480852,20654025,0,-31400660 },
+  { 5230134,16520125,0,1370708 },
+  { -23952439,30598449,0,29794553 },
+  { -15175766,7715701,0,-1409300 },
+ },
+ {
+  { -22518993,-6455177,2,4566830 },
+  { -6692182,-7839871,0,-12963868 },
+  { 14201702,3374702,0,-28974889 },
+  { -8745502,-4740862,0,-12240689 },
+  { -23510406,-27098617,0,-7602672 },
+  { 8844726,-10571707,0,-2830569 },
+  { 18474211,31655028,0,-8514358 },
+  { -1361450,-7212327,0,-10431137 },
+  { -13062696,18853322,0,2207753 },
+  { 13821877,-14220951,0,-3209784 },
+ },
+ {
+  { -25154831,25576264,2,23103977 },
+  { -4185821,-2703214,0,13316479 },
+  { 29681144,7349804,0,9739013 },
+  { 7868801,-11814844,0,-16149481 },
+  { -6854661,16472782,0,817875 },
+  { -9423865,9300885,0,-15038942 },
+  { -12437364,3844789,0,8965339 },
+  { -663000,15725684,0,-14088058 },
+  { -31111463,171356,0,-30714912 },
+  { -16132436,6466918,0,16193877 },
+ },
+ {
+  { -33521811,-25182317,2,-13720693 },
+  { 3180713,-4174131,0,2639453 },
+  { -2394130,32336398,0,-24237460 },
+  { 14003687,5036987,0,-7406481 },
+  { -16903474,-21236817,0,9494427 },
+  { -16270840,11360617,0,-5774029 },
+  { 17238398,22616405,0,-6554551 },
+  { 4729455,9761698,0,-15960994 },
+  { -18074513,-19827198,0,-2449256 },
+  { 9256800,630305,0,-14291300 },
+ },
+ {
+  { -3151181,-24326370,2,-3099351 },
+  { -5046075,15950226,0,10324967 },
+  { 9282714,-31801215,0,-2241613 },
+  { 6866145,-14592823,0,7453183 },
+  { -31907062,-11662737,0,-5446979 },
+  { -863023,-5090925,0,-2735503 },
+  { -18940575,1573892,0,-13812022 },
+  { 15033784,-2625887,0,-16236442 },
+  { 25105118,2198790,0,-32461234 },
+  { -7894876,-15804619,0,-12290683 },
+ },
@@ -0,0 +1,544 @@
+#include <stdlib.h>
+#include <string.h>
+#include "backend.h"
+#include "ed25519.h"
+#include "../sha512.h"
+#include "crypto_verify_32.h"
+#include "ge.h"
+#include "sc.h"
+
+/* Below this many signatures one-by-one verification is faster. */
+#define BATCH_MIN 4
+
+/* Failing groups this small are split into single verifications. */
+#define LOCATE_LEAF 8
+
+typedef struct {
+  ge_p3 negR;
+  unsigned char h[32];
+  unsigned char z[16];
+  const unsigned char *sig;
+  size_t key;
+} batch_item;
+
+/* a public key as it appears in the batch, for sorting */
+typedef struct {
+  const unsigned char *pk;
+  size_t i;
+} batch_key_ref;
+
+/* marks an item whose public key does not decode */
+#define NO_KEY ((size_t) -1)
+
+/* B, the Ed25519 base point (x,4/5) with x positive */
+static const unsigned char B_bytes[32] = {
+  0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+  0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+  0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+  0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+};
+
+/*
+Decodes R for the batch equation. Encodings that crypto_sign_verify could
+never match (y >= p, or x = 0 with the sign bit set) are rejected so a batch
+accepts only what a single verification would.
+*/
+
+static int decode_R(ge_p3 *negR,const unsigned char *s)
+{
+  unsigned char check[32];
+  fe y;
+  int i;
+
+  if (ge_frombytes_negate_vartime(negR,s) != 0) return -1;
+  fe_frombytes(y,s);
+  fe_tobytes(check,y);
+  check[31] |= s[31] & 128;
+  for (i = 0;i < 32;++i) if (check[i] != s[i]) return -1;
+  if (!fe_isnonzero(negR->X) && (s[31] & 128)) return -1;
+  return 0;
+}
+
+static int compare_key_refs(const void *a,const void *b)
+{
+  const batch_key_ref *x = (const batch_key_ref *) a;
+  const batch_key_ref *y = (const batch_key_ref *) b;
+  int c = memcmp(x->pk,y->pk,32);
+  if (c != 0) return c;
+  return x->i < y->i ? -1 : x->i > y->i;
+}
+
+/*
+Decodes each distinct public key once. Sorting the keys groups equal ones
+without a hash table an attacker could fill with collisions.
+key_of[i]: set to the index in negA of public_keys[i], or NO_KEY
+returns: the number of distinct valid keys written to negA
+*/
+
+static size_t decode_keys(ge_p3 *negA,size_t *key_of,batch_key_ref *refs,
+                          const unsigned char * const *public_keys,size_t count)
+{
+  size_t k = 0;
+  size_t i;
+
+  for (i = 0;i < count;++i) {
+    refs[i].pk = public_keys[i];
+    refs[i].i = i;
+  }
+  qsort(refs,count,sizeof(batch_key_ref),compare_key_refs);
+
+  for (i = 0;i < count;++i) {
+    if (i > 0 && memcmp(refs[i].pk,refs[i - 1].pk,32) == 0) {
+      key_of[refs[i].i] = key_of[refs[i - 1].i];
+    } else if (ge_frombytes_negate_vartime(&negA[k],refs[i].pk) == 0) {
+      key_of[refs[i].i] = k++;
+    } else {
+      key_of[refs[i].i] = NO_KEY;
+    }
+  }
+  return k;
+}
+
+static int prepare(batch_item *item,const unsigned char *m,size_t mlen,const unsigned char *sig,const unsigned char *pk,size_t key)
+{
+  unsigned char h[64];
+  sha512_context hash;
+
+  if (sig[63] & 224) return -1;
+  if (key == NO_KEY) return -1;
+
+  sha512_init(&hash);
+  sha512_update(&hash,sig,32);
+  sha512_update(&hash,pk,32);
+  sha512_update(&hash,m,mlen);
+  sha512_final(&hash,h);
+  sc_reduce(h);
+  memcpy(item->h,h,32);
+  item->sig = sig;
+  item->key = key;
+  return 0;
+}
+
+/* crypto_sign_verify on an item whose hash and key are already computed */
+static int verify_one(const batch_item *item,const ge_p3 *negA)
+{
+  unsigned char checkr[32];
+  ge_p2 R;
+
+  ge_double_scalarmult_vartime(&R,item->h,&negA[item->key],item->sig + 32);
+  ge_tobytes(checkr,&R);
+  return crypto_verify_32(checkr,item->sig);
+}
+
+/* byte counts rounded up so each scratch array stays aligned */
+#define ROUND16(x) (((x) + 15) & ~(size_t) 15)
+
+static size_t check_scratch_bytes(size_t n)
+{
+  return ROUND16(32 * (2 * n + 1))
+       + ROUND16(sizeof(ge_p3) * (2 * n + 1))
+       + ge_multi_scalarmult_scratch_bytes(2 * n + 1);
+}
+
+/* State shared by the checks of one batch and its subsets. */
+typedef struct {
+  batch_item *items;
+  const size_t *index;
+  const ge_p3 *negA;
+  size_t *slot;
+  unsigned char *scratch;
+  ge_p3 B;
+  size_t budget;
+  unsigned char *valid;
+  int result;
+} batch_ctx;
+
+/*
+Gives item i the coefficient z_i, 128 bits of SHA-512(digest || i/4) where
+digest hashes the random seed and every item. The coefficients are fixed
+for the whole batch, so the batch sum is exactly the sum of the sums of
+any split of it.
+*/
+
+static void derive_z(batch_item *items,size_t n,const unsigned char *random)
+{
+  unsigned char digest[64];
+  unsigned char counter[8];
+  sha512_context hash;
+  size_t i;
+  int j;
+
+  sha512_init(&hash);
+  sha512_update(&hash,random,32);
+  for (i = 0;i < n;++i) {
+    sha512_update(&hash,items[i].sig,64);
+    sha512_update(&hash,items[i].h,32);
+  }
+  sha512_final(&hash,digest);
+
+  for (i = 0;i < n;++i) {
+    if ((i & 3) == 0) {
+      for (j = 0;j < 8;++j) counter[j] = (unsigned char) ((i >> 2) >> (8 * j));
+      sha512_init(&hash);
+      sha512_update(&hash,digest,32);
+      sha512_update(&hash,counter,8);
+      sha512_final(&hash,digest + 32);
+    }
+    memcpy(items[i].z,digest + 32 + 16 * (i & 3),16);
+  }
+}
+
+/*
+Computes sum z_i (R_i + h_i A_i - S_i B) over items[lo..lo+n), negated.
+Items sharing a key add up their z_i h_i, so each distinct key is one term
+of the multi-scalar multiplication; ctx->slot maps a key to its term and
+is left all NO_KEY again afterwards. Only keys of these n items are
+counted, so k <= n and the 2n+1 terms of check_scratch_bytes suffice.
+*/
+
+static void batch_sum(batch_ctx *ctx,size_t lo,size_t n,ge_p3 *sum)
+{
+  unsigned char *scalars = ctx->scratch;
+  ge_p3 *points = (ge_p3 *) (ctx->scratch + ROUND16(32 * (2 * n + 1)));
+  unsigned char z[32];
+  const batch_item *item;
+  size_t k = 0;
+  size_t i;
+  size_t *slot;
+
+  points[0] = ctx->B;
+  memset(scalars,0,32);
+  memset(z,0,32);
+
+  for (i = 0;i < n;++i) {
+    item = &ctx->items[lo + i];
+    slot = &ctx->slot[item->key];
+    if (*slot == NO_KEY) {
+      *slot = k;
+      memset(scalars + 32 * (1 + n + k),0,32);
+      points[1 + n + k] = ctx->negA[item->key];
+      ++k;
+    }
+    memcpy(z,item->z,16);
+    sc_muladd(scalars,z,item->sig + 32,scalars);
+    memcpy(scalars + 32 * (1 + i),z,32);
+    sc_muladd(scalars + 32 * (1 + n + *slot),z,item->h,scalars + 32 * (1 + n + *slot));
+    points[1 + i] = item->negR;
+  }
+  for (i = 0;i < n;++i) ctx->slot[ctx->items[lo + i].key] = NO_KEY;
+
+  /* [sum z_i S_i] B + sum [z_i] (-R_i) + sum_A [sum z_i h_i] (-A) */
+  ge_multi_scalarmult_vartime_scratch(sum,scalars,points,1 + n + k,(unsigned char *) points + ROUND16(sizeof(ge_p3) * (2 * n + 1)));
+}
+
+/*
+Returns 0 if the cofactor times sum is the identity, 1 if not. Z = 0 is
+no point at all, so it fails too rather than passing as X = 0, Y = Z.
+*/
+static int fails(const ge_p3 *sum)
+{
+  ge_p1p1 t;
+  ge_p2 u;
+  fe yminusz;
+
+  ge_p3_dbl(&t,sum); ge_p1p1_to_p2(&u,&t);
+  ge_p2_dbl(&t,&u); ge_p1p1_to_p2(&u,&t);
+  ge_p2_dbl(&t,&u); ge_p1p1_to_p2(&u,&t);
+
+  fe_sub(yminusz,u.Y,u.Z);
+  return fe_isnonzero(u.X) || fe_isnonzero(yminusz) || !fe_isnonzero(u.Z);
+}
+
+/*
+Splits the failing sum of items[lo..lo+n) into the sums of its halves.
+With fixed z_i the right half's sum is the whole minus the left's, so a
+split costs one multi-scalar multiplication over half the items.
+Returns -1 once ctx->budget is spent, otherwise 0. The budget starts at
+the batch size and every half found valid adds its size back, so splits
+that pay off continue while, however an attacker spreads the invalid
+signatures, the splits that clear nothing add up to about one more
+batch check on top of verifying one by one.
+*/
+
+static int split(batch_ctx *ctx,size_t lo,size_t n,const ge_p3 *sum,ge_p3 *left,ge_p3 *right)
+{
+  size_t half = n / 2;
+  ge_cached c;
+  ge_p1p1 t;
+
+  if (half > ctx->budget) return -1;
+  ctx->budget -= half;
+  batch_sum(ctx,lo,half,left);
+  ge_p3_to_cached(&c,left);
+  ge_sub(&t,sum,&c);
+  ge_p1p1_to_p3(right,&t);
+  return 0;
+}
+
+static void mark_one_by_one(batch_ctx *ctx,size_t lo,size_t n)
+{
+  size_t i;
+
+  for (i = lo;i < lo + n;++i) {
+    if (verify_one(&ctx->items[i],ctx->negA) != 0) {
+      ctx->valid[ctx->index[i]] = 0;
+      ctx->result = -1;
+    }
+  }
+}
+
+/*
+Marks the invalid items of items[lo..lo+n), whose batch sum fails, by
+splitting it until the failing parts are LOCATE_LEAF items or fewer.
+*/
+
+static void locate(batch_ctx *ctx,size_t lo,size_t n,const ge_p3 *sum)
+{
+  size_t half = n / 2;
+  ge_p3 left;
+  ge_p3 right;
+
+  if (n <= LOCATE_LEAF || split(ctx,lo,n,sum,&left,&right) != 0) {
+    mark_one_by_one(ctx,lo,n);
+    return;
+  }
+  if (fails(&left)) locate(ctx,lo,half,&left);
+  else ctx->budget += half;
+  if (fails(&right)) locate(ctx,lo + half,n - half,&right);
+  else ctx->budget += n - half;
+}
+
+static size_t first_one_by_one(batch_ctx *ctx,size_t lo,size_t n)
+{
+  size_t i;
+
+  for (i = lo;i < lo + n;++i) {
+    if (verify_one(&ctx->items[i],ctx->negA) != 0) return i;
+  }
+  return lo + n;
+}
+
+/*
+locate for the first invalid item only: the left half is searched first
+and the right half is never touched once a bad item turns up.
+Returns the position of the first invalid item, or lo + n if none is.
+*/
+
+static size_t locate_first(batch_ctx *ctx,size_t lo,size_t n,const ge_p3 *sum)
+{
+  size_t half = n / 2;
+  size_t first;
+  ge_p3 left;
+  ge_p3 right;
+
+  if (n <= LOCATE_LEAF || split(ctx,lo,n,sum,&left,&right) != 0) {
+    return first_one_by_one(ctx,lo,n);
+  }
+  if (fails(&left)) {
+    first = locate_first(ctx,lo,half,&left);
+    if (first < lo + half) return first;
+  } else {
+    ctx->budget += half;
+  }
+  if (fails(&right)) return locate_first(ctx,lo + half,n - half,&right);
+  return lo + n;
+}
+
+/*
+Bytes of scratch memory crypto_sign_verify_batch_scratch needs for count
+signatures. check_scratch_bytes never shrinks as n grows, so this covers
+a batch that loses items to failed decoding, and its subsets, too.
+*/
+
+size_t crypto_sign_verify_batch_scratch_bytes(size_t count)
+{
+  return ROUND16(sizeof(batch_item) * count)
+       + ROUND16(sizeof(size_t) * count)
+       + ROUND16(sizeof(size_t) * count)
+       + ROUND16(sizeof(batch_key_ref) * count)
+       + ROUND16(sizeof(ge_p3) * count)
+       + ROUND16(sizeof(size_t) * count)
+       + check_scratch_bytes(count);
+}
+
+/*
+Lays out scratch, decodes the keys and prepares the items in order. In
+fail-fast mode preparing stops at the first item that fails.
+Returns the number of prepared items; ctx->index maps them back.
+*/
+
+static size_t setup(batch_ctx *ctx,const unsigned char * const *messages,const size_t *message_lens,
+                    const unsigned char * const *signatures,const unsigned char * const *public_keys,
+                    size_t count,const unsigned char *random,unsigned char *valid,int fail_fast,void *scratch)
+{
+  batch_item *items = (batch_item *) scratch;
+  size_t *index = (size_t *) ((unsigned char *) items + ROUND16(sizeof(batch_item) * count));
+  size_t *key_of = (size_t *) ((unsigned char *) index + ROUND16(sizeof(size_t) * count));
+  batch_key_ref *refs = (batch_key_ref *) ((unsigned char *) key_of + ROUND16(sizeof(size_t) * count));
+  ge_p3 *negA = (ge_p3 *) ((unsigned char *) refs + ROUND16(sizeof(batch_key_ref) * count));
+  size_t *slot = (size_t *) ((unsigned char *) negA + ROUND16(sizeof(ge_p3) * count));
+  size_t n = 0;
+  size_t k;
+  size_t i;
+
+  ctx->items = items;
+  ctx->index = index;
+  ctx->negA = negA;
+  ctx->slot = slot;
+  ctx->scratch = (unsigned char *) slot + ROUND16(sizeof(size_t) * count);
+  ctx->valid = valid;
+  ctx->result = 0;
+
+  k = decode_keys(negA,key_of,refs,public_keys,count);
+  for (i = 0;i < k;++i) slot[i] = NO_KEY;
+
+  for (i = 0;i < count;++i) {
+    if (prepare(&items[n],messages[i],message_lens[i],signatures[i],public_keys[i],key_of[i]) != 0 ||
+        decode_R(&items[n].negR,signatures[i]) != 0) {
+      if (valid) valid[i] = 0;
+      ctx->result = -1;
+      if (fail_fast) break;
+    } else {
+      if (valid) valid[i] = 1;
+      index[n++] = i;
+    }
+  }
+
+  /* B, the base point, negated back from its decoding */
+  ge_frombytes_negate_vartime(&ctx->B,B_bytes);
+  fe_neg(ctx->B.X,ctx->B.X);
+  fe_neg(ctx->B.T,ctx->B.T);
+  ctx->budget = n;
+
+  derive_z(items,n,random);
+  return n;
+}
+
+/*
+Verifies n signatures at once.
+random: 32 unpredictable bytes for the batch coefficients
+valid: set to 1 for each signature that verifies, 0 otherwise
+scratch: 16 byte aligned, crypto_sign_verify_batch_scratch_bytes(count) long
+returns: 0 if every signature verifies, -1 otherwise
+
+The batch equation is checked multiplied by the cofactor 8. Signatures made
+by the signing functions verify exactly as they do with crypto_sign_verify;
+a signature crafted with a small order component may be accepted here and
+rejected there. When the batch equation fails the invalid signatures are
+found by splitting the batch in halves, reusing the hashes and decoded
+points, down to groups of LOCATE_LEAF verified one by one. Each distinct
+public key is decoded once, however many signatures in the batch use it.
+*/
+
+int crypto_sign_verify_batch_scratch(const unsigned char * const *messages, const size_t *message_lens,
+                                     const unsigned char * const *signatures, const unsigned char * const *public_keys,
+                                     size_t count, const unsigned char *random, unsigned char *valid,
+                                     void *scratch)
+{
+  batch_ctx ctx;
+  ge_p3 sum;
+  size_t n;
+  size_t i;
+  int result = 0;
+
+  if (count < BATCH_MIN) {
+    for (i = 0;i < count;++i) {
+      valid[i] = crypto_sign_verify(signatures[i],messages[i],message_lens[i],public_keys[i]) == 0;
+      if (!valid[i]) result = -1;
+    }
+    return result;
+  }
+
+  n = setup(&ctx,messages,message_lens,signatures,public_keys,count,random,valid,0,scratch);
+  if (n > 0) {
+    batch_sum(&ctx,0,n,&sum);
+    if (fails(&sum)) locate(&ctx,0,n,&sum);
+  }
+  return ctx.result;
+}
+
+/*
+Like crypto_sign_verify_batch_scratch, but stops at the first invalid
+signature instead of finding them all.
+returns: the index of the first invalid signature, or count if all verify
+*/
+
+size_t crypto_sign_verify_batch_first_invalid_scratch(const unsigned char * const *messages, const size_t *message_lens,
+                                                      const unsigned char * const *signatures, const unsigned char * const *public_keys,
+                                                      size_t count, const unsigned char *random, void *scratch)
+{
+  batch_ctx ctx;
+  ge_p3 sum;
+  size_t n;
+  size_t i;
+
+  if (count < BATCH_MIN) {
+    for (i = 0;i < count;++i) {
+      if (crypto_sign_verify(signatures[i],messages[i],message_lens[i],public_keys[i]) != 0) return i;
+    }
+    return count;
+  }
+
+  /* the prepared items are exactly those before the first bad one */
+  n = setup(&ctx,messages,message_lens,signatures,public_keys,count,random,NULL,1,scratch);
+  if (n > 0) {
+    batch_sum(&ctx,0,n,&sum);
+    if (fails(&sum)) {
+      i = locate_first(&ctx,0,n,&sum);
+      if (i < n) return i;
+    }
+  }
+  return n;
+}
+
+/*
+crypto_sign_verify_batch_scratch with malloc'd scratch memory. If that
+fails the signatures are verified one by one.
+*/
+
+int crypto_sign_verify_batch(const unsigned char * const *messages, const size_t *message_lens,
+                             const unsigned char * const *signatures, const unsigned char * const *public_keys,
+                             size_t count, const unsigned char *random, unsigned char *valid)
+{
+  void *scratch;
+  size_t i;
+  int result = 0;
+
+  scratch = count < BATCH_MIN ? NULL : malloc(crypto_sign_verify_batch_scratch_bytes(count));
+  if (!scratch) {
+    for (i = 0;i < count;++i) {
+      valid[i] = crypto_sign_verify(signatures[i],messages[i],message_lens[i],public_keys[i]) == 0;
+      if (!valid[i]) result = -1;
+    }
+    return result;
+  }
+
+  result = crypto_sign_verify_batch_scratch(messages,message_lens,signatures,public_keys,count,random,valid,scratch);
+  free(scratch);
+  return result;
+}
+
+/*
+crypto_sign_verify_batch_first_invalid_scratch with malloc'd scratch
+memory, or one by one verification if that fails.
+*/
+
+size_t crypto_sign_verify_batch_first_invalid(const unsigned char * const *messages, const size_t *message_lens,
+                                              const unsigned char * const *signatures, const unsigned char * const *public_keys,
+                                              size_t count, const unsigned char *random)
+{
+  void *scratch;
+  size_t i;
+
+  scratch = count < BATCH_MIN ? NULL : malloc(crypto_sign_verify_batch_scratch_bytes(count));
+  if (!scratch) {
+    for (i = 0;i < count;++i) {
+      if (crypto_sign_verify(signatures[i],messages[i],message_lens[i],public_keys[i]) != 0) return i;
+    }
+    return count;
+  }
+
+  i = crypto_sign_verify_batch_first_invalid_scratch(messages,message_lens,signatures,public_keys,count,random,scratch);
+  free(scratch);
+  return i;
+}
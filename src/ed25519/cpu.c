@@ -0,0 +1,74 @@
+#include "cpu.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static void cpuid(unsigned int leaf,unsigned int *regs)
+{
+#ifdef _MSC_VER
+  int r[4];
+  __cpuidex(r,(int) leaf,0);
+  regs[0] = r[0]; regs[1] = r[1]; regs[2] = r[2]; regs[3] = r[3];
+#else
+  __cpuid_count(leaf,0,regs[0],regs[1],regs[2],regs[3]);
+#endif
+}
+
+/* XCR0: which register state the operating system saves */
+static unsigned long long xgetbv(void)
+{
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  unsigned int eax;
+  unsigned int edx;
+  __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((unsigned long long) edx << 32) | eax;
+#endif
+}
+
+static int detect(void)
+{
+  unsigned int regs[4];
+  int features = 0;
+
+  cpuid(0,regs);
+  if (regs[0] < 7) return 0;
+
+  cpuid(7,regs);
+  if (regs[1] & (1 << 8)) features |= ED25519_CPU_BMI2;
+  if (regs[1] & (1 << 19)) features |= ED25519_CPU_ADX;
+
+  if (regs[1] & (1 << 5)) {
+    cpuid(1,regs);
+    /* OSXSAVE and AVX, then the OS must save both XMM and YMM state */
+    if ((regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && (xgetbv() & 6) == 6)
+      features |= ED25519_CPU_AVX2;
+  }
+  return features;
+}
+#else
+static int detect(void)
+{
+  return 0;
+}
+#endif
+
+/* Racing threads all store the same value, so no locking is needed. */
+static volatile int features = -1;
+
+int ed25519_cpu_features(void)
+{
+  if (features < 0) features = detect();
+  return features;
+}
+
+void ed25519_cpu_restrict(int mask)
+{
+  features = ed25519_cpu_features() & mask;
+}
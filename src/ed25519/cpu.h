@@ -0,0 +1,21 @@
+#ifndef CPU_H
+#define CPU_H
+
+/*
+Run time detection of the x86-64 extensions the vectorized code paths use.
+Always 0 on other architectures.
+*/
+
+#define ED25519_CPU_AVX2 1
+#define ED25519_CPU_BMI2 2
+#define ED25519_CPU_ADX 4
+
+#define ed25519_cpu_features crypto_sign_ed25519_ref10_cpu_features
+#define ed25519_cpu_restrict crypto_sign_ed25519_ref10_cpu_restrict
+
+extern int ed25519_cpu_features(void);
+
+/* Hides every feature not in mask from later ed25519_cpu_features calls. */
+extern void ed25519_cpu_restrict(int mask);
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef CRYPTO_INT128_H
+#define CRYPTO_INT128_H
+typedef __int128 crypto_int128;
+#endif
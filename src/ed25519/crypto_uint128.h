@@ -0,0 +1,4 @@
+#ifndef CRYPTO_UINT128_H
+#define CRYPTO_UINT128_H
+typedef unsigned __int128 crypto_uint128;
+#endif
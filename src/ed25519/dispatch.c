@@ -0,0 +1,257 @@
+#include <string.h>
+#include "ed25519.h"
+#include "dispatch.h"
+#include "cpu.h"
+
+extern const crypto_sign_backend crypto_sign_ed25519_ref10_backend;
+#ifdef ED25519_HAVE_FE51
+extern const crypto_sign_backend crypto_sign_ed25519_fe51_backend;
+#endif
+#ifdef ED25519_HAVE_FE64
+extern const crypto_sign_backend crypto_sign_ed25519_fe64_backend;
+#endif
+
+#define AVX2 ED25519_CPU_AVX2
+#define MULX (ED25519_CPU_BMI2 | ED25519_CPU_ADX)
+
+/*
+The backends built into this binary, fastest first. A backend is picked
+automatically when the CPU has every feature in needs; once picked, only
+the features in allows stay visible to the code paths that test them.
+*/
+static const struct {
+  const char *name;
+  const crypto_sign_backend *code;
+  int needs;
+  int allows;
+} backends[] = {
+#ifdef ED25519_HAVE_FE64
+  { "fe64-adx", &crypto_sign_ed25519_fe64_backend, MULX, MULX | AVX2 },
+#endif
+#ifdef ED25519_HAVE_FE51
+  { "fe51-avx2", &crypto_sign_ed25519_fe51_backend, AVX2, AVX2 },
+  { "fe51", &crypto_sign_ed25519_fe51_backend, 0, 0 },
+#endif
+  { "ref10-avx2", &crypto_sign_ed25519_ref10_backend, AVX2, AVX2 },
+  { "ref10", &crypto_sign_ed25519_ref10_backend, 0, 0 }
+};
+
+#define BACKENDS ((int) (sizeof backends / sizeof backends[0]))
+
+/* Racing threads all pick the same backend, so no locking is needed. */
+static volatile int detected = -1;
+static volatile int active = -1;
+
+/*
+Picks the backend called name, or the fastest one the CPU supports when
+name is NULL, empty, unknown or needs a feature the CPU lacks. Only the
+first call picks, since objects made by one backend cannot be used by
+another; the first crypto_sign_* call picks automatically. Returns 0 if
+the backend in use matches name.
+*/
+int crypto_sign_backend_select(const char *name)
+{
+  int found = -1;
+  int i;
+
+  if (name != NULL && name[0] == '\0') name = NULL;
+  if (active >= 0)
+    return name == NULL || strcmp(name,backends[active].name) == 0 ? 0 : -1;
+
+  if (detected < 0) detected = ed25519_cpu_features();
+  if (name != NULL)
+    for (i = 0;i < BACKENDS;++i)
+      if (strcmp(name,backends[i].name) == 0 && (detected & backends[i].needs) == backends[i].needs) found = i;
+  if (found < 0)
+    for (i = BACKENDS - 1;i >= 0;--i)
+      if ((detected & backends[i].needs) == backends[i].needs) found = i;
+
+  ed25519_cpu_restrict(backends[found].allows);
+  active = found;
+  return name == NULL || strcmp(name,backends[found].name) == 0 ? 0 : -1;
+}
+
+static const crypto_sign_backend *current(void)
+{
+  if (active < 0) crypto_sign_backend_select(NULL);
+  return backends[active].code;
+}
+
+void crypto_sign_backend_get_info(crypto_sign_backend_info *info)
+{
+  const crypto_sign_backend *code = current();
+  int features = ed25519_cpu_features();
+
+  info->name = backends[active].name;
+  info->field = code->field;
+  if (strcmp(code->field,"fe64") == 0)
+    info->field_mul = (features & MULX) == MULX ? "mulx" : "int128";
+  else if (strcmp(code->field,"fe51") == 0)
+    info->field_mul = "int128";
+  else
+    info->field_mul = "int64";
+  info->base_x4 = features & AVX2 ? "avx2" : "scalar";
+  info->double_scalarmult = features & AVX2 && strcmp(code->field,"ref10") == 0 ? "avx2" : "scalar";
+#ifdef ED25519_SAFEGCD
+  info->invert = "safegcd";
+#else
+  info->invert = "pow";
+#endif
+  info->sha512 = "scalar";
+}
+
+const char *crypto_sign_backend_available(size_t index)
+{
+  int i;
+
+  current();
+  for (i = 0;i < BACKENDS;++i)
+    if ((detected & backends[i].needs) == backends[i].needs)
+      if (index-- == 0) return backends[i].name;
+  return NULL;
+}
+
+int crypto_sign_keypair(unsigned char *pk,unsigned char *sk)
+{
+  return current()->keypair(pk,sk);
+}
+
+int crypto_sign_keypair_batch(unsigned char *pk,unsigned char *sk,size_t count)
+{
+  return current()->keypair_batch(pk,sk,count);
+}
+
+int crypto_sign_open(unsigned char *m,unsigned long long *mlen,const unsigned char *sm,
+                     unsigned long long smlen,const unsigned char *pk)
+{
+  return current()->open(m,mlen,sm,smlen,pk);
+}
+
+int crypto_sign(unsigned char *sm,unsigned long long *smlen,const unsigned char *m,
+                unsigned long long mlen,const unsigned char *sk)
+{
+  return current()->sign(sm,smlen,m,mlen,sk);
+}
+
+int crypto_sign_detached(unsigned char *sig,const unsigned char *m,size_t mlen,const unsigned char *sk)
+{
+  return current()->detached(sig,m,mlen,sk);
+}
+
+void crypto_sign_expand(unsigned char *az,const unsigned char *sk)
+{
+  current()->expand(az,sk);
+}
+
+int crypto_sign_detached_expanded(unsigned char *sig,const unsigned char *m,size_t mlen,
+                                  const unsigned char *az,const unsigned char *pk)
+{
+  return current()->detached_expanded(sig,m,mlen,az,pk);
+}
+
+crypto_sign_signer *crypto_sign_signer_new(const unsigned char *sk)
+{
+  return current()->signer_new(sk);
+}
+
+void crypto_sign_signer_update(crypto_sign_signer *s,const unsigned char *m,size_t mlen)
+{
+  current()->signer_update(s,m,mlen);
+}
+
+int crypto_sign_signer_rewind(crypto_sign_signer *s)
+{
+  return current()->signer_rewind(s);
+}
+
+int crypto_sign_signer_final(crypto_sign_signer *s,unsigned char *sig)
+{
+  return current()->signer_final(s,sig);
+}
+
+void crypto_sign_signer_free(crypto_sign_signer *s)
+{
+  current()->signer_free(s);
+}
+
+int crypto_sign_batch(unsigned char *sigs,const unsigned char * const *messages,
+                      const size_t *message_lens,size_t count,const unsigned char *sk)
+{
+  return current()->batch(sigs,messages,message_lens,count,sk);
+}
+
+int crypto_sign_verify(const unsigned char *signature,const unsigned char *message,
+                       size_t message_len,const unsigned char *public_key)
+{
+  return current()->verify(signature,message,message_len,public_key);
+}
+
+crypto_sign_verifying_key *crypto_sign_verifying_key_new(const unsigned char *pk,int *status)
+{
+  return current()->verifying_key_new(pk,status);
+}
+
+void crypto_sign_verifying_key_free(crypto_sign_verifying_key *key)
+{
+  current()->verifying_key_free(key);
+}
+
+int crypto_sign_verify_with_key(const unsigned char *signature,const unsigned char *message,
+                                size_t message_len,const crypto_sign_verifying_key *key)
+{
+  return current()->verify_with_key(signature,message,message_len,key);
+}
+
+crypto_sign_verifier *crypto_sign_verifier_new(const unsigned char *signature,const unsigned char *pk)
+{
+  return current()->verifier_new(signature,pk);
+}
+
+void crypto_sign_verifier_update(crypto_sign_verifier *v,const unsigned char *m,size_t mlen)
+{
+  current()->verifier_update(v,m,mlen);
+}
+
+int crypto_sign_verifier_final(crypto_sign_verifier *v)
+{
+  return current()->verifier_final(v);
+}
+
+void crypto_sign_verifier_free(crypto_sign_verifier *v)
+{
+  current()->verifier_free(v);
+}
+
+int crypto_sign_verify_batch(const unsigned char * const *messages,const size_t *message_lens,
+                             const unsigned char * const *signatures,const unsigned char * const *public_keys,
+                             size_t count,const unsigned char *random,unsigned char *valid)
+{
+  return current()->verify_batch(messages,message_lens,signatures,public_keys,count,random,valid);
+}
+
+size_t crypto_sign_verify_batch_scratch_bytes(size_t count)
+{
+  return current()->verify_batch_scratch_bytes(count);
+}
+
+int crypto_sign_verify_batch_scratch(const unsigned char * const *messages,const size_t *message_lens,
+                                     const unsigned char * const *signatures,const unsigned char * const *public_keys,
+                                     size_t count,const unsigned char *random,unsigned char *valid,
+                                     void *scratch)
+{
+  return current()->verify_batch_scratch(messages,message_lens,signatures,public_keys,count,random,valid,scratch);
+}
+
+size_t crypto_sign_verify_batch_first_invalid(const unsigned char * const *messages,const size_t *message_lens,
+                                              const unsigned char * const *signatures,const unsigned char * const *public_keys,
+                                              size_t count,const unsigned char *random)
+{
+  return current()->verify_batch_first_invalid(messages,message_lens,signatures,public_keys,count,random);
+}
+
+size_t crypto_sign_verify_batch_first_invalid_scratch(const unsigned char * const *messages,const size_t *message_lens,
+                                                      const unsigned char * const *signatures,const unsigned char * const *public_keys,
+                                                      size_t count,const unsigned char *random,void *scratch)
+{
+  return current()->verify_batch_first_invalid_scratch(messages,message_lens,signatures,public_keys,count,random,scratch);
+}
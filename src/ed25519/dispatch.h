@@ -0,0 +1,41 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include "ed25519.h"
+
+/*
+One compiled copy of the signature code (see backend.h). Each entry is the
+copy's version of the crypto_sign_* function with the same name.
+*/
+
+typedef struct {
+  const char *field;
+  int (*keypair)(unsigned char *,unsigned char *);
+  int (*keypair_batch)(unsigned char *,unsigned char *,size_t);
+  int (*open)(unsigned char *,unsigned long long *,const unsigned char *,unsigned long long,const unsigned char *);
+  int (*sign)(unsigned char *,unsigned long long *,const unsigned char *,unsigned long long,const unsigned char *);
+  int (*detached)(unsigned char *,const unsigned char *,size_t,const unsigned char *);
+  void (*expand)(unsigned char *,const unsigned char *);
+  int (*detached_expanded)(unsigned char *,const unsigned char *,size_t,const unsigned char *,const unsigned char *);
+  crypto_sign_signer *(*signer_new)(const unsigned char *);
+  void (*signer_update)(crypto_sign_signer *,const unsigned char *,size_t);
+  int (*signer_rewind)(crypto_sign_signer *);
+  int (*signer_final)(crypto_sign_signer *,unsigned char *);
+  void (*signer_free)(crypto_sign_signer *);
+  int (*batch)(unsigned char *,const unsigned char * const *,const size_t *,size_t,const unsigned char *);
+  int (*verify)(const unsigned char *,const unsigned char *,size_t,const unsigned char *);
+  crypto_sign_verifying_key *(*verifying_key_new)(const unsigned char *,int *);
+  void (*verifying_key_free)(crypto_sign_verifying_key *);
+  int (*verify_with_key)(const unsigned char *,const unsigned char *,size_t,const crypto_sign_verifying_key *);
+  crypto_sign_verifier *(*verifier_new)(const unsigned char *,const unsigned char *);
+  void (*verifier_update)(crypto_sign_verifier *,const unsigned char *,size_t);
+  int (*verifier_final)(crypto_sign_verifier *);
+  void (*verifier_free)(crypto_sign_verifier *);
+  int (*verify_batch)(const unsigned char * const *,const size_t *,const unsigned char * const *,const unsigned char * const *,size_t,const unsigned char *,unsigned char *);
+  size_t (*verify_batch_scratch_bytes)(size_t);
+  int (*verify_batch_scratch)(const unsigned char * const *,const size_t *,const unsigned char * const *,const unsigned char * const *,size_t,const unsigned char *,unsigned char *,void *);
+  size_t (*verify_batch_first_invalid)(const unsigned char * const *,const size_t *,const unsigned char * const *,const unsigned char * const *,size_t,const unsigned char *);
+  size_t (*verify_batch_first_invalid_scratch)(const unsigned char * const *,const size_t *,const unsigned char * const *,const unsigned char * const *,size_t,const unsigned char *,void *);
+} crypto_sign_backend;
+
+#endif
@@ -7,13 +7,65 @@
 extern "C" {
 #endif
 
+	typedef struct crypto_sign_verifying_key crypto_sign_verifying_key;
+	typedef struct crypto_sign_verifier crypto_sign_verifier;
+	typedef struct crypto_sign_signer crypto_sign_signer;
+
+	typedef struct crypto_sign_backend_info {
+		const char *name;
+		const char *field;
+		const char *field_mul;
+		const char *base_x4;
+		const char *double_scalarmult;
+		const char *invert;
+		const char *sha512;
+	} crypto_sign_backend_info;
+
+	int crypto_sign_backend_select(const char *name);
+	void crypto_sign_backend_get_info(crypto_sign_backend_info *info);
+	const char *crypto_sign_backend_available(size_t index);
+
 	int crypto_sign_keypair(unsigned char *pk, unsigned char *sk);
+	int crypto_sign_keypair_batch(unsigned char *pk, unsigned char *sk, size_t count);
 	int crypto_sign_open(unsigned char *m, unsigned long long *mlen, const unsigned char *sm,
 						 unsigned long long smlen, const unsigned char *pk);
 	int crypto_sign(unsigned char *sm, unsigned long long *smlen, const unsigned char *m,
 					unsigned long long mlen, const unsigned char *sk);
+	int crypto_sign_detached(unsigned char *sig, const unsigned char *m, size_t mlen, const unsigned char *sk);
+	void crypto_sign_expand(unsigned char *az, const unsigned char *sk);
+	int crypto_sign_detached_expanded(unsigned char *sig, const unsigned char *m, size_t mlen,
+									  const unsigned char *az, const unsigned char *pk);
+	crypto_sign_signer *crypto_sign_signer_new(const unsigned char *sk);
+	void crypto_sign_signer_update(crypto_sign_signer *s, const unsigned char *m, size_t mlen);
+	int crypto_sign_signer_rewind(crypto_sign_signer *s);
+	int crypto_sign_signer_final(crypto_sign_signer *s, unsigned char *sig);
+	void crypto_sign_signer_free(crypto_sign_signer *s);
+	int crypto_sign_batch(unsigned char *sigs, const unsigned char * const *messages,
+						  const size_t *message_lens, size_t count, const unsigned char *sk);
 	int crypto_sign_verify(const unsigned char *signature, const unsigned char *message,
 						   size_t message_len, const unsigned char *public_key);
+	crypto_sign_verifying_key *crypto_sign_verifying_key_new(const unsigned char *pk, int *status);
+	void crypto_sign_verifying_key_free(crypto_sign_verifying_key *key);
+	int crypto_sign_verify_with_key(const unsigned char *signature, const unsigned char *message,
+									size_t message_len, const crypto_sign_verifying_key *key);
+	crypto_sign_verifier *crypto_sign_verifier_new(const unsigned char *signature, const unsigned char *pk);
+	void crypto_sign_verifier_update(crypto_sign_verifier *v, const unsigned char *m, size_t mlen);
+	int crypto_sign_verifier_final(crypto_sign_verifier *v);
+	void crypto_sign_verifier_free(crypto_sign_verifier *v);
+	int crypto_sign_verify_batch(const unsigned char * const *messages, const size_t *message_lens,
+								 const unsigned char * const *signatures, const unsigned char * const *public_keys,
+								 size_t count, const unsigned char *random, unsigned char *valid);
+	size_t crypto_sign_verify_batch_scratch_bytes(size_t count);
+	int crypto_sign_verify_batch_scratch(const unsigned char * const *messages, const size_t *message_lens,
+										 const unsigned char * const *signatures, const unsigned char * const *public_keys,
+										 size_t count, const unsigned char *random, unsigned char *valid,
+										 void *scratch);
+	size_t crypto_sign_verify_batch_first_invalid(const unsigned char * const *messages, const size_t *message_lens,
+												  const unsigned char * const *signatures, const unsigned char * const *public_keys,
+												  size_t count, const unsigned char *random);
+	size_t crypto_sign_verify_batch_first_invalid_scratch(const unsigned char * const *messages, const size_t *message_lens,
+														  const unsigned char * const *signatures, const unsigned char * const *public_keys,
+														  size_t count, const unsigned char *random, void *scratch);
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,43 @@
 #ifndef FE_H
 #define FE_H
 
+#include "backend.h"
+
+#if defined(ED25519_FE64)
+
+#include "crypto_uint64.h"
+
+typedef crypto_uint64 fe[4];
+
+/*
+fe means field element.
+Here the field is \Z/(2^255-19).
+An element t, entries t[0]...t[3], represents the integer
+t[0]+2^64 t[1]+2^128 t[2]+2^192 t[3].
+Any value below 2^256 is allowed; only fe_tobytes reduces fully.
+This representation needs a compiler with unsigned __int128.
+The functions that depend on it are in fe64/.
+*/
+
+#elif defined(ED25519_FE51)
+
+#include "crypto_uint64.h"
+
+typedef crypto_uint64 fe[5];
+
+/*
+fe means field element.
+Here the field is \Z/(2^255-19).
+An element t, entries t[0]...t[4], represents the integer
+t[0]+2^51 t[1]+2^102 t[2]+2^153 t[3]+2^204 t[4].
+Entries are unsigned and may exceed 2^51 between operations;
+bounds on each t[i] vary depending on context.
+This representation needs a compiler with unsigned __int128.
+The functions that depend on it are in fe51/.
+*/
+
+#else
+
 #include "crypto_int32.h"
 
 typedef crypto_int32 fe[10];
@@ -13,24 +50,26 @@ t[0]+2^26 t[1]+2^51 t[2]+2^77 t[3]+2^102 t[4]+...+2^230 t[9].
 Bounds on each t[i] vary depending on context.
 */
 
-#define fe_frombytes crypto_sign_ed25519_ref10_fe_frombytes
-#define fe_tobytes crypto_sign_ed25519_ref10_fe_tobytes
-#define fe_copy crypto_sign_ed25519_ref10_fe_copy
-#define fe_isnonzero crypto_sign_ed25519_ref10_fe_isnonzero
-#define fe_isnegative crypto_sign_ed25519_ref10_fe_isnegative
-#define fe_0 crypto_sign_ed25519_ref10_fe_0
-#define fe_1 crypto_sign_ed25519_ref10_fe_1
-#define fe_cswap crypto_sign_ed25519_ref10_fe_cswap
-#define fe_cmov crypto_sign_ed25519_ref10_fe_cmov
-#define fe_add crypto_sign_ed25519_ref10_fe_add
-#define fe_sub crypto_sign_ed25519_ref10_fe_sub
-#define fe_neg crypto_sign_ed25519_ref10_fe_neg
-#define fe_mul crypto_sign_ed25519_ref10_fe_mul
-#define fe_sq crypto_sign_ed25519_ref10_fe_sq
-#define fe_sq2 crypto_sign_ed25519_ref10_fe_sq2
-#define fe_mul121666 crypto_sign_ed25519_ref10_fe_mul121666
-#define fe_invert crypto_sign_ed25519_ref10_fe_invert
-#define fe_pow22523 crypto_sign_ed25519_ref10_fe_pow22523
+#endif
+
+#define fe_frombytes ED25519_NAME(fe_frombytes)
+#define fe_tobytes ED25519_NAME(fe_tobytes)
+#define fe_copy ED25519_NAME(fe_copy)
+#define fe_isnonzero ED25519_NAME(fe_isnonzero)
+#define fe_isnegative ED25519_NAME(fe_isnegative)
+#define fe_0 ED25519_NAME(fe_0)
+#define fe_1 ED25519_NAME(fe_1)
+#define fe_cswap ED25519_NAME(fe_cswap)
+#define fe_cmov ED25519_NAME(fe_cmov)
+#define fe_add ED25519_NAME(fe_add)
+#define fe_sub ED25519_NAME(fe_sub)
+#define fe_neg ED25519_NAME(fe_neg)
+#define fe_mul ED25519_NAME(fe_mul)
+#define fe_sq ED25519_NAME(fe_sq)
+#define fe_sq2 ED25519_NAME(fe_sq2)
+#define fe_mul121666 ED25519_NAME(fe_mul121666)
+#define fe_invert ED25519_NAME(fe_invert)
+#define fe_pow22523 ED25519_NAME(fe_pow22523)
 
 extern void fe_frombytes(fe,const unsigned char *);
 extern void fe_tobytes(unsigned char *,const fe);
@@ -0,0 +1,426 @@
+#ifndef FE4_H
+#define FE4_H
+
+/*
+fe4 holds four field elements, one per 64-bit lane of the AVX2 registers:
+limb i of lane j lives in v[i] lane j, using the same radix 2^25.5
+representation and bounds as the ref10 fe, so fe4_mul and fe4_sq are line
+by line transcriptions of fe_mul.c and fe_sq.c.
+
+The functions are static and compiled for AVX2 whatever the build flags
+are; callers check ed25519_cpu_features() first. HAVE_AVX2_X4 is only
+defined where the compiler can build them.
+
+With the radix 2^51 or 2^64 fields (ED25519_FE51, ED25519_FE64) results
+are converted with fe_from10 and inputs with fe_to10.
+*/
+
+#include "fe.h"
+#include "crypto_int32.h"
+#include "crypto_int64.h"
+#ifdef ED25519_FE64
+#include "crypto_uint128.h"
+#endif
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+#define HAVE_AVX2_X4
+#endif
+
+#ifdef HAVE_AVX2_X4
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define AVX2 __inline __attribute__((target("avx2")))
+#else
+#define AVX2 __inline
+#endif
+
+typedef struct {
+  __m256i v[10];
+} fe4;
+
+static AVX2 void fe4_0(fe4 *h)
+{
+  int i;
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_setzero_si256();
+}
+
+static AVX2 void fe4_1(fe4 *h)
+{
+  fe4_0(h);
+  h->v[0] = _mm256_set1_epi64x(1);
+}
+
+static AVX2 void fe4_add(fe4 *h,const fe4 *f,const fe4 *g)
+{
+  int i;
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_add_epi64(f->v[i],g->v[i]);
+}
+
+static AVX2 void fe4_sub(fe4 *h,const fe4 *f,const fe4 *g)
+{
+  int i;
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_sub_epi64(f->v[i],g->v[i]);
+}
+
+static AVX2 void fe4_neg(fe4 *h,const fe4 *f)
+{
+  int i;
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_sub_epi64(_mm256_setzero_si256(),f->v[i]);
+}
+
+/* h = f where mask lanes are all ones, h unchanged where they are zero */
+static AVX2 void fe4_cmov(fe4 *h,const fe4 *f,__m256i mask)
+{
+  int i;
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_blendv_epi8(h->v[i],f->v[i],mask);
+}
+
+/*
+h = f + g in lanes where sub is zero, f - g where it is all ones.
+Lanes of g where keep is zero count as 0.
+*/
+static AVX2 void fe4_addsub(fe4 *h,const fe4 *f,const fe4 *g,__m256i keep,__m256i sub)
+{
+  __m256i x;
+  int i;
+  for (i = 0;i < 10;++i) {
+    x = _mm256_xor_si256(_mm256_and_si256(g->v[i],keep),sub);
+    h->v[i] = _mm256_add_epi64(f->v[i],_mm256_sub_epi64(x,sub));
+  }
+}
+
+/*
+Lane j of h = lane k of f, where idx holds 2k and 2k+1 in its 32-bit
+elements 2j and 2j+1; see fe4_lanes.
+*/
+static AVX2 void fe4_shuffle(fe4 *h,const fe4 *f,__m256i idx)
+{
+  int i;
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_permutevar8x32_epi32(f->v[i],idx);
+}
+
+/* the fe4_shuffle index taking lanes a,b,c,d of its input */
+static AVX2 __m256i fe4_lanes(int a,int b,int c,int d)
+{
+  return _mm256_set_epi32(2 * d + 1,2 * d,2 * c + 1,2 * c,2 * b + 1,2 * b,2 * a + 1,2 * a);
+}
+
+/* AVX2 has no 64-bit arithmetic right shift */
+static AVX2 __m256i sra64(__m256i x,int n)
+{
+  __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(),x);
+  return _mm256_or_si256(_mm256_srli_epi64(x,n),_mm256_slli_epi64(sign,64 - n));
+}
+
+/* carry = (h[i] + 2^(bits-1)) >> bits; h[i+1] += carry; h[i] -= carry << bits */
+static AVX2 void carry(__m256i *h,int i,int bits)
+{
+  __m256i c = sra64(_mm256_add_epi64(h[i],_mm256_set1_epi64x((long long) 1 << (bits - 1))),bits);
+  h[i] = _mm256_sub_epi64(h[i],_mm256_slli_epi64(c,bits));
+  if (i == 9) {
+    /* h[0] += 19 * carry */
+    h[0] = _mm256_add_epi64(h[0],_mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(c,4),_mm256_slli_epi64(c,1)),c));
+  } else {
+    h[i + 1] = _mm256_add_epi64(h[i + 1],c);
+  }
+}
+
+static AVX2 void fe4_carry(fe4 *h,__m256i *r)
+{
+  int i;
+
+  carry(r,0,26); carry(r,4,26);
+  carry(r,1,25); carry(r,5,25);
+  carry(r,2,26); carry(r,6,26);
+  carry(r,3,25); carry(r,7,25);
+  carry(r,4,26); carry(r,8,26);
+  carry(r,9,25);
+  carry(r,0,26);
+
+  for (i = 0;i < 10;++i) h->v[i] = r[i];
+}
+
+/*
+h = f * g, or 2 * f * g if dbl.
+Same preconditions and postconditions as fe_mul.
+*/
+
+#define MAC(h,a,b) h = _mm256_add_epi64(h,_mm256_mul_epi32(a,b))
+
+static AVX2 void fe4_mul(fe4 *h,const fe4 *f,const fe4 *g,int dbl)
+{
+  __m256i nineteen = _mm256_set1_epi64x(19);
+  __m256i f0 = f->v[0];
+  __m256i f1 = f->v[1];
+  __m256i f2 = f->v[2];
+  __m256i f3 = f->v[3];
+  __m256i f4 = f->v[4];
+  __m256i f5 = f->v[5];
+  __m256i f6 = f->v[6];
+  __m256i f7 = f->v[7];
+  __m256i f8 = f->v[8];
+  __m256i f9 = f->v[9];
+  __m256i g0 = g->v[0];
+  __m256i g1 = g->v[1];
+  __m256i g2 = g->v[2];
+  __m256i g3 = g->v[3];
+  __m256i g4 = g->v[4];
+  __m256i g5 = g->v[5];
+  __m256i g6 = g->v[6];
+  __m256i g7 = g->v[7];
+  __m256i g8 = g->v[8];
+  __m256i g9 = g->v[9];
+  __m256i g1_19 = _mm256_mul_epi32(g1,nineteen);
+  __m256i g2_19 = _mm256_mul_epi32(g2,nineteen);
+  __m256i g3_19 = _mm256_mul_epi32(g3,nineteen);
+  __m256i g4_19 = _mm256_mul_epi32(g4,nineteen);
+  __m256i g5_19 = _mm256_mul_epi32(g5,nineteen);
+  __m256i g6_19 = _mm256_mul_epi32(g6,nineteen);
+  __m256i g7_19 = _mm256_mul_epi32(g7,nineteen);
+  __m256i g8_19 = _mm256_mul_epi32(g8,nineteen);
+  __m256i g9_19 = _mm256_mul_epi32(g9,nineteen);
+  __m256i f1_2 = _mm256_add_epi64(f1,f1);
+  __m256i f3_2 = _mm256_add_epi64(f3,f3);
+  __m256i f5_2 = _mm256_add_epi64(f5,f5);
+  __m256i f7_2 = _mm256_add_epi64(f7,f7);
+  __m256i f9_2 = _mm256_add_epi64(f9,f9);
+  __m256i r[10];
+  int i;
+
+  r[0] = _mm256_mul_epi32(f0,g0);
+  MAC(r[0],f1_2,g9_19); MAC(r[0],f2,g8_19); MAC(r[0],f3_2,g7_19);
+  MAC(r[0],f4,g6_19); MAC(r[0],f5_2,g5_19); MAC(r[0],f6,g4_19);
+  MAC(r[0],f7_2,g3_19); MAC(r[0],f8,g2_19); MAC(r[0],f9_2,g1_19);
+  r[1] = _mm256_mul_epi32(f0,g1);
+  MAC(r[1],f1,g0); MAC(r[1],f2,g9_19); MAC(r[1],f3,g8_19);
+  MAC(r[1],f4,g7_19); MAC(r[1],f5,g6_19); MAC(r[1],f6,g5_19);
+  MAC(r[1],f7,g4_19); MAC(r[1],f8,g3_19); MAC(r[1],f9,g2_19);
+  r[2] = _mm256_mul_epi32(f0,g2);
+  MAC(r[2],f1_2,g1); MAC(r[2],f2,g0); MAC(r[2],f3_2,g9_19);
+  MAC(r[2],f4,g8_19); MAC(r[2],f5_2,g7_19); MAC(r[2],f6,g6_19);
+  MAC(r[2],f7_2,g5_19); MAC(r[2],f8,g4_19); MAC(r[2],f9_2,g3_19);
+  r[3] = _mm256_mul_epi32(f0,g3);
+  MAC(r[3],f1,g2); MAC(r[3],f2,g1); MAC(r[3],f3,g0);
+  MAC(r[3],f4,g9_19); MAC(r[3],f5,g8_19); MAC(r[3],f6,g7_19);
+  MAC(r[3],f7,g6_19); MAC(r[3],f8,g5_19); MAC(r[3],f9,g4_19);
+  r[4] = _mm256_mul_epi32(f0,g4);
+  MAC(r[4],f1_2,g3); MAC(r[4],f2,g2); MAC(r[4],f3_2,g1);
+  MAC(r[4],f4,g0); MAC(r[4],f5_2,g9_19); MAC(r[4],f6,g8_19);
+  MAC(r[4],f7_2,g7_19); MAC(r[4],f8,g6_19); MAC(r[4],f9_2,g5_19);
+  r[5] = _mm256_mul_epi32(f0,g5);
+  MAC(r[5],f1,g4); MAC(r[5],f2,g3); MAC(r[5],f3,g2);
+  MAC(r[5],f4,g1); MAC(r[5],f5,g0); MAC(r[5],f6,g9_19);
+  MAC(r[5],f7,g8_19); MAC(r[5],f8,g7_19); MAC(r[5],f9,g6_19);
+  r[6] = _mm256_mul_epi32(f0,g6);
+  MAC(r[6],f1_2,g5); MAC(r[6],f2,g4); MAC(r[6],f3_2,g3);
+  MAC(r[6],f4,g2); MAC(r[6],f5_2,g1); MAC(r[6],f6,g0);
+  MAC(r[6],f7_2,g9_19); MAC(r[6],f8,g8_19); MAC(r[6],f9_2,g7_19);
+  r[7] = _mm256_mul_epi32(f0,g7);
+  MAC(r[7],f1,g6); MAC(r[7],f2,g5); MAC(r[7],f3,g4);
+  MAC(r[7],f4,g3); MAC(r[7],f5,g2); MAC(r[7],f6,g1);
+  MAC(r[7],f7,g0); MAC(r[7],f8,g9_19); MAC(r[7],f9,g8_19);
+  r[8] = _mm256_mul_epi32(f0,g8);
+  MAC(r[8],f1_2,g7); MAC(r[8],f2,g6); MAC(r[8],f3_2,g5);
+  MAC(r[8],f4,g4); MAC(r[8],f5_2,g3); MAC(r[8],f6,g2);
+  MAC(r[8],f7_2,g1); MAC(r[8],f8,g0); MAC(r[8],f9_2,g9_19);
+  r[9] = _mm256_mul_epi32(f0,g9);
+  MAC(r[9],f1,g8); MAC(r[9],f2,g7); MAC(r[9],f3,g6);
+  MAC(r[9],f4,g5); MAC(r[9],f5,g4); MAC(r[9],f6,g3);
+  MAC(r[9],f7,g2); MAC(r[9],f8,g1); MAC(r[9],f9,g0);
+
+  if (dbl) {
+    for (i = 0;i < 10;++i) r[i] = _mm256_add_epi64(r[i],r[i]);
+  }
+
+  fe4_carry(h,r);
+}
+
+/*
+h = f * f, doubled in the lanes where dbl is all ones.
+Same preconditions and postconditions as fe_sq.
+*/
+
+static AVX2 void fe4_sq(fe4 *h,const fe4 *f,__m256i dbl)
+{
+  __m256i f0 = f->v[0];
+  __m256i f1 = f->v[1];
+  __m256i f2 = f->v[2];
+  __m256i f3 = f->v[3];
+  __m256i f4 = f->v[4];
+  __m256i f5 = f->v[5];
+  __m256i f6 = f->v[6];
+  __m256i f7 = f->v[7];
+  __m256i f8 = f->v[8];
+  __m256i f9 = f->v[9];
+  __m256i f0_2 = _mm256_add_epi64(f0,f0);
+  __m256i f1_2 = _mm256_add_epi64(f1,f1);
+  __m256i f2_2 = _mm256_add_epi64(f2,f2);
+  __m256i f3_2 = _mm256_add_epi64(f3,f3);
+  __m256i f4_2 = _mm256_add_epi64(f4,f4);
+  __m256i f5_2 = _mm256_add_epi64(f5,f5);
+  __m256i f6_2 = _mm256_add_epi64(f6,f6);
+  __m256i f7_2 = _mm256_add_epi64(f7,f7);
+  __m256i f5_38 = _mm256_mul_epi32(f5,_mm256_set1_epi64x(38));
+  __m256i f6_19 = _mm256_mul_epi32(f6,_mm256_set1_epi64x(19));
+  __m256i f7_38 = _mm256_mul_epi32(f7,_mm256_set1_epi64x(38));
+  __m256i f8_19 = _mm256_mul_epi32(f8,_mm256_set1_epi64x(19));
+  __m256i f9_38 = _mm256_mul_epi32(f9,_mm256_set1_epi64x(38));
+  __m256i r[10];
+  int i;
+
+  r[0] = _mm256_mul_epi32(f0,f0);
+  MAC(r[0],f1_2,f9_38); MAC(r[0],f2_2,f8_19); MAC(r[0],f3_2,f7_38);
+  MAC(r[0],f4_2,f6_19); MAC(r[0],f5,f5_38);
+  r[1] = _mm256_mul_epi32(f0_2,f1);
+  MAC(r[1],f2,f9_38); MAC(r[1],f3_2,f8_19); MAC(r[1],f4,f7_38);
+  MAC(r[1],f5_2,f6_19);
+  r[2] = _mm256_mul_epi32(f0_2,f2);
+  MAC(r[2],f1_2,f1); MAC(r[2],f3_2,f9_38); MAC(r[2],f4_2,f8_19);
+  MAC(r[2],f5_2,f7_38); MAC(r[2],f6,f6_19);
+  r[3] = _mm256_mul_epi32(f0_2,f3);
+  MAC(r[3],f1_2,f2); MAC(r[3],f4,f9_38); MAC(r[3],f5_2,f8_19);
+  MAC(r[3],f6,f7_38);
+  r[4] = _mm256_mul_epi32(f0_2,f4);
+  MAC(r[4],f1_2,f3_2); MAC(r[4],f2,f2); MAC(r[4],f5_2,f9_38);
+  MAC(r[4],f6_2,f8_19); MAC(r[4],f7,f7_38);
+  r[5] = _mm256_mul_epi32(f0_2,f5);
+  MAC(r[5],f1_2,f4); MAC(r[5],f2_2,f3); MAC(r[5],f6,f9_38);
+  MAC(r[5],f7_2,f8_19);
+  r[6] = _mm256_mul_epi32(f0_2,f6);
+  MAC(r[6],f1_2,f5_2); MAC(r[6],f2_2,f4); MAC(r[6],f3_2,f3);
+  MAC(r[6],f7_2,f9_38); MAC(r[6],f8,f8_19);
+  r[7] = _mm256_mul_epi32(f0_2,f7);
+  MAC(r[7],f1_2,f6); MAC(r[7],f2_2,f5); MAC(r[7],f3_2,f4);
+  MAC(r[7],f8,f9_38);
+  r[8] = _mm256_mul_epi32(f0_2,f8);
+  MAC(r[8],f1_2,f7_2); MAC(r[8],f2_2,f6); MAC(r[8],f3_2,f5_2);
+  MAC(r[8],f4,f4); MAC(r[8],f9,f9_38);
+  r[9] = _mm256_mul_epi32(f0_2,f9);
+  MAC(r[9],f1_2,f8); MAC(r[9],f2_2,f7); MAC(r[9],f3_2,f6);
+  MAC(r[9],f4_2,f5);
+
+  for (i = 0;i < 10;++i) r[i] = _mm256_add_epi64(r[i],_mm256_and_si256(r[i],dbl));
+
+  fe4_carry(h,r);
+}
+
+#if defined(ED25519_FE51) || defined(ED25519_FE64)
+/*
+h = f, from ten radix 2^25.5 limbs to five radix 2^51 limbs, packed into
+four 64-bit words for ED25519_FE64.
+Limbs 2k and 2k+1 of f are 26 bits apart, so each pair adds up to limb k
+of h. Adding 4q = 2^257 - 76 makes every limb positive before the carry.
+
+Preconditions:
+   |f| bounded by 1.1*2^26,1.1*2^25,1.1*2^26,1.1*2^25,etc.
+*/
+
+static __inline void fe_from10(fe h,const crypto_int32 *f)
+{
+  const crypto_uint64 mask = ((crypto_uint64) 1 << 51) - 1;
+  crypto_uint64 l[5];
+#ifdef ED25519_FE64
+  crypto_uint128 c;
+#endif
+  int k;
+
+  for (k = 0;k < 5;++k)
+    l[k] = (crypto_uint64) ((crypto_int64) f[2 * k] + (crypto_int64) f[2 * k + 1] * ((crypto_int64) 1 << 26)
+                            + ((crypto_int64) 1 << 53) - (k == 0 ? 76 : 4));
+  l[1] += l[0] >> 51; l[0] &= mask;
+  l[2] += l[1] >> 51; l[1] &= mask;
+  l[3] += l[2] >> 51; l[2] &= mask;
+  l[4] += l[3] >> 51; l[3] &= mask;
+  l[0] += 19 * (l[4] >> 51); l[4] &= mask;
+#ifdef ED25519_FE64
+  c = l[0] + ((crypto_uint128) l[1] << 51); h[0] = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) l[2] << 38; h[1] = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) l[3] << 25; h[2] = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) l[4] << 12; h[3] = (crypto_uint64) c;
+#else
+  for (k = 0;k < 5;++k) h[k] = l[k];
+#endif
+}
+
+/*
+h = f, in ten radix 2^25.5 limbs cut from the bytes of f and then carried
+with rounding as in fe_frombytes, so that sums of two limbs still meet the
+preconditions of fe4_mul.
+
+Postconditions:
+   |h| bounded by 1.1*2^25,1.1*2^24,1.1*2^25,1.1*2^24,etc.
+*/
+
+static __inline void fe_to10(crypto_int32 *h,const fe f)
+{
+  static const int offset[10] = { 0,26,51,77,102,128,153,179,204,230 };
+  unsigned char s[40] = { 0 };
+  crypto_int64 l[10];
+  crypto_int64 c;
+  crypto_uint64 w;
+  int bits;
+  int i;
+  int k;
+
+  fe_tobytes(s,f);
+  for (i = 0;i < 10;++i) {
+    w = 0;
+    for (k = 7;k >= 0;--k) w = (w << 8) | s[offset[i] / 8 + k];
+    l[i] = (crypto_int64) ((w >> (offset[i] & 7)) & ((1 << (i & 1 ? 25 : 26)) - 1));
+  }
+  for (i = 0;i < 10;++i) {
+    bits = i & 1 ? 25 : 26;
+    c = (l[i] + ((crypto_int64) 1 << (bits - 1))) >> bits;
+    l[i] -= c << bits;
+    if (i < 9) l[i + 1] += c; else l[0] += c * 19;
+  }
+  for (i = 0;i < 10;++i) h[i] = (crypto_int32) l[i];
+}
+#endif
+
+/* h[j] = lane j of f */
+static AVX2 void fe4_extract(fe *h,const fe4 *f)
+{
+  long long lanes[4];
+  crypto_int32 t[4][10];
+  int i;
+  int j;
+
+  for (i = 0;i < 10;++i) {
+    _mm256_storeu_si256((__m256i *) lanes,f->v[i]);
+    for (j = 0;j < 4;++j) t[j][i] = (crypto_int32) lanes[j];
+  }
+  for (j = 0;j < 4;++j) {
+#if defined(ED25519_FE51) || defined(ED25519_FE64)
+    fe_from10(h[j],t[j]);
+#else
+    for (i = 0;i < 10;++i) h[j][i] = t[j][i];
+#endif
+  }
+}
+
+/* lane j of h = f[j] */
+static AVX2 void fe4_insert(fe4 *h,const fe f0,const fe f1,const fe f2,const fe f3)
+{
+  crypto_int32 t[4][10];
+  int i;
+
+#if defined(ED25519_FE51) || defined(ED25519_FE64)
+  fe_to10(t[0],f0);
+  fe_to10(t[1],f1);
+  fe_to10(t[2],f2);
+  fe_to10(t[3],f3);
+#else
+  for (i = 0;i < 10;++i) {
+    t[0][i] = f0[i];
+    t[1][i] = f1[i];
+    t[2][i] = f2[i];
+    t[3][i] = f3[i];
+  }
+#endif
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_set_epi64x(t[3][i],t[2][i],t[1][i],t[0][i]);
+}
+#endif
+
+#endif
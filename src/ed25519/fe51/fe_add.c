@@ -0,0 +1,21 @@
+#include "../fe.h"
+
+/*
+h = f + g
+Can overlap h with f or g.
+
+Preconditions:
+   f[i], g[i] bounded by 2^53.
+
+Postconditions:
+   h[i] bounded by 2^54.
+*/
+
+void fe_add(fe h,const fe f,const fe g)
+{
+  h[0] = f[0] + g[0];
+  h[1] = f[1] + g[1];
+  h[2] = f[2] + g[2];
+  h[3] = f[3] + g[3];
+  h[4] = f[4] + g[4];
+}
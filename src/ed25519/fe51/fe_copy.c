@@ -0,0 +1,19 @@
+#include "../fe.h"
+
+/*
+h = f
+*/
+
+void fe_copy(fe h,const fe f)
+{
+  crypto_uint64 f0 = f[0];
+  crypto_uint64 f1 = f[1];
+  crypto_uint64 f2 = f[2];
+  crypto_uint64 f3 = f[3];
+  crypto_uint64 f4 = f[4];
+  h[0] = f0;
+  h[1] = f1;
+  h[2] = f2;
+  h[3] = f3;
+  h[4] = f4;
+}
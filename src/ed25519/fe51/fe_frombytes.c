@@ -0,0 +1,29 @@
+#include "../fe.h"
+
+static crypto_uint64 load_8(const unsigned char *in)
+{
+  crypto_uint64 result;
+  result = (crypto_uint64) in[0];
+  result |= ((crypto_uint64) in[1]) << 8;
+  result |= ((crypto_uint64) in[2]) << 16;
+  result |= ((crypto_uint64) in[3]) << 24;
+  result |= ((crypto_uint64) in[4]) << 32;
+  result |= ((crypto_uint64) in[5]) << 40;
+  result |= ((crypto_uint64) in[6]) << 48;
+  result |= ((crypto_uint64) in[7]) << 56;
+  return result;
+}
+
+/*
+Ignores top bit of h.
+*/
+
+void fe_frombytes(fe h,const unsigned char *s)
+{
+  const crypto_uint64 mask = ((crypto_uint64) 1 << 51) - 1;
+  h[0] = load_8(s) & mask;
+  h[1] = (load_8(s + 6) >> 3) & mask;
+  h[2] = (load_8(s + 12) >> 6) & mask;
+  h[3] = (load_8(s + 19) >> 1) & mask;
+  h[4] = (load_8(s + 24) >> 12) & mask;
+}
@@ -0,0 +1,73 @@
+#include "../fe.h"
+#include "../crypto_uint128.h"
+
+/*
+h = f * g
+Can overlap h with f or g.
+
+Preconditions:
+   f[i], g[i] bounded by 2^54.
+
+Postconditions:
+   h[i] bounded by 2^51 + 2^13.
+*/
+
+/*
+Schoolbook multiplication on five 51-bit limbs: 25 products of 64x64 bits
+summed into 128-bit columns. Since 2^255 = 19 mod q, the products that
+land at 2^255 and above are folded back in by multiplying g1...g4 by 19
+up front. One carry pass then brings every limb back to about 51 bits.
+*/
+
+void fe_mul(fe h,const fe f,const fe g)
+{
+  const crypto_uint64 mask = ((crypto_uint64) 1 << 51) - 1;
+  crypto_uint64 f0 = f[0];
+  crypto_uint64 f1 = f[1];
+  crypto_uint64 f2 = f[2];
+  crypto_uint64 f3 = f[3];
+  crypto_uint64 f4 = f[4];
+  crypto_uint64 g0 = g[0];
+  crypto_uint64 g1 = g[1];
+  crypto_uint64 g2 = g[2];
+  crypto_uint64 g3 = g[3];
+  crypto_uint64 g4 = g[4];
+  crypto_uint64 g1_19 = 19 * g1;
+  crypto_uint64 g2_19 = 19 * g2;
+  crypto_uint64 g3_19 = 19 * g3;
+  crypto_uint64 g4_19 = 19 * g4;
+  crypto_uint128 r0;
+  crypto_uint128 r1;
+  crypto_uint128 r2;
+  crypto_uint128 r3;
+  crypto_uint128 r4;
+  crypto_uint64 h0;
+  crypto_uint64 h1;
+  crypto_uint64 h2;
+  crypto_uint64 h3;
+  crypto_uint64 h4;
+
+  r0 = (crypto_uint128) f0 * g0 + (crypto_uint128) f1 * g4_19 + (crypto_uint128) f2 * g3_19
+     + (crypto_uint128) f3 * g2_19 + (crypto_uint128) f4 * g1_19;
+  r1 = (crypto_uint128) f0 * g1 + (crypto_uint128) f1 * g0 + (crypto_uint128) f2 * g4_19
+     + (crypto_uint128) f3 * g3_19 + (crypto_uint128) f4 * g2_19;
+  r2 = (crypto_uint128) f0 * g2 + (crypto_uint128) f1 * g1 + (crypto_uint128) f2 * g0
+     + (crypto_uint128) f3 * g4_19 + (crypto_uint128) f4 * g3_19;
+  r3 = (crypto_uint128) f0 * g3 + (crypto_uint128) f1 * g2 + (crypto_uint128) f2 * g1
+     + (crypto_uint128) f3 * g0 + (crypto_uint128) f4 * g4_19;
+  r4 = (crypto_uint128) f0 * g4 + (crypto_uint128) f1 * g3 + (crypto_uint128) f2 * g2
+     + (crypto_uint128) f3 * g1 + (crypto_uint128) f4 * g0;
+
+  h0 = (crypto_uint64) r0 & mask; r1 += (crypto_uint64) (r0 >> 51);
+  h1 = (crypto_uint64) r1 & mask; r2 += (crypto_uint64) (r1 >> 51);
+  h2 = (crypto_uint64) r2 & mask; r3 += (crypto_uint64) (r2 >> 51);
+  h3 = (crypto_uint64) r3 & mask; r4 += (crypto_uint64) (r3 >> 51);
+  h4 = (crypto_uint64) r4 & mask; h0 += 19 * (crypto_uint64) (r4 >> 51);
+  h1 += h0 >> 51; h0 &= mask;
+
+  h[0] = h0;
+  h[1] = h1;
+  h[2] = h2;
+  h[3] = h3;
+  h[4] = h4;
+}
@@ -0,0 +1,33 @@
+#include "../fe.h"
+
+/*
+h = -f
+
+Preconditions:
+   f[i] bounded by 2^63.
+
+Postconditions:
+   h[i] bounded by 2^52.
+*/
+
+void fe_neg(fe h,const fe f)
+{
+  const crypto_uint64 mask = ((crypto_uint64) 1 << 51) - 1;
+  crypto_uint64 f0 = f[0];
+  crypto_uint64 f1 = f[1];
+  crypto_uint64 f2 = f[2];
+  crypto_uint64 f3 = f[3];
+  crypto_uint64 f4 = f[4];
+
+  f1 += f0 >> 51; f0 &= mask;
+  f2 += f1 >> 51; f1 &= mask;
+  f3 += f2 >> 51; f2 &= mask;
+  f4 += f3 >> 51; f3 &= mask;
+  f0 += 19 * (f4 >> 51); f4 &= mask;
+
+  h[0] = 0xfffffffffffda - f0;
+  h[1] = 0xffffffffffffe - f1;
+  h[2] = 0xffffffffffffe - f2;
+  h[3] = 0xffffffffffffe - f3;
+  h[4] = 0xffffffffffffe - f4;
+}
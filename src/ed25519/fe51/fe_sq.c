@@ -0,0 +1,63 @@
+#include "../fe.h"
+#include "../crypto_uint128.h"
+
+/*
+h = f * f
+Can overlap h with f.
+
+Preconditions:
+   f[i] bounded by 2^54.
+
+Postconditions:
+   h[i] bounded by 2^51 + 2^13.
+*/
+
+/*
+See fe_mul.c for discussion of implementation strategy.
+*/
+
+void fe_sq(fe h,const fe f)
+{
+  const crypto_uint64 mask = ((crypto_uint64) 1 << 51) - 1;
+  crypto_uint64 f0 = f[0];
+  crypto_uint64 f1 = f[1];
+  crypto_uint64 f2 = f[2];
+  crypto_uint64 f3 = f[3];
+  crypto_uint64 f4 = f[4];
+  crypto_uint64 f0_2 = 2 * f0;
+  crypto_uint64 f1_2 = 2 * f1;
+  crypto_uint64 f1_38 = 38 * f1;
+  crypto_uint64 f2_38 = 38 * f2;
+  crypto_uint64 f3_38 = 38 * f3;
+  crypto_uint64 f3_19 = 19 * f3;
+  crypto_uint64 f4_19 = 19 * f4;
+  crypto_uint128 r0;
+  crypto_uint128 r1;
+  crypto_uint128 r2;
+  crypto_uint128 r3;
+  crypto_uint128 r4;
+  crypto_uint64 h0;
+  crypto_uint64 h1;
+  crypto_uint64 h2;
+  crypto_uint64 h3;
+  crypto_uint64 h4;
+
+  r0 = (crypto_uint128) f0 * f0 + (crypto_uint128) f1_38 * f4 + (crypto_uint128) f2_38 * f3;
+  r1 = (crypto_uint128) f0_2 * f1 + (crypto_uint128) f2_38 * f4 + (crypto_uint128) f3_19 * f3;
+  r2 = (crypto_uint128) f0_2 * f2 + (crypto_uint128) f1 * f1 + (crypto_uint128) f3_38 * f4;
+  r3 = (crypto_uint128) f0_2 * f3 + (crypto_uint128) f1_2 * f2 + (crypto_uint128) f4_19 * f4;
+  r4 = (crypto_uint128) f0_2 * f4 + (crypto_uint128) f1_2 * f3 + (crypto_uint128) f2 * f2;
+
+  h0 = (crypto_uint64) r0 & mask; r1 += (crypto_uint64) (r0 >> 51);
+  h1 = (crypto_uint64) r1 & mask; r2 += (crypto_uint64) (r1 >> 51);
+  h2 = (crypto_uint64) r2 & mask; r3 += (crypto_uint64) (r2 >> 51);
+  h3 = (crypto_uint64) r3 & mask; r4 += (crypto_uint64) (r3 >> 51);
+  h4 = (crypto_uint64) r4 & mask; h0 += 19 * (crypto_uint64) (r4 >> 51);
+  h1 += h0 >> 51; h0 &= mask;
+
+  h[0] = h0;
+  h[1] = h1;
+  h[2] = h2;
+  h[3] = h3;
+  h[4] = h4;
+}
@@ -0,0 +1,39 @@
+#include "../fe.h"
+
+/*
+h = f - g
+Can overlap h with f or g.
+
+Limbs are unsigned, so g is carried down below 2^51 (plus a small top
+carry into h0) and h is computed as f + 2q - g, which cannot wrap.
+
+Preconditions:
+   f[i] bounded by 2^53.
+   g[i] bounded by 2^63.
+
+Postconditions:
+   h[i] bounded by 2^54.
+*/
+
+void fe_sub(fe h,const fe f,const fe g)
+{
+  const crypto_uint64 mask = ((crypto_uint64) 1 << 51) - 1;
+  crypto_uint64 g0 = g[0];
+  crypto_uint64 g1 = g[1];
+  crypto_uint64 g2 = g[2];
+  crypto_uint64 g3 = g[3];
+  crypto_uint64 g4 = g[4];
+
+  g1 += g0 >> 51; g0 &= mask;
+  g2 += g1 >> 51; g1 &= mask;
+  g3 += g2 >> 51; g2 &= mask;
+  g4 += g3 >> 51; g3 &= mask;
+  g0 += 19 * (g4 >> 51); g4 &= mask;
+
+  /* 2q = 2^256 - 38 */
+  h[0] = (f[0] + 0xfffffffffffda) - g0;
+  h[1] = (f[1] + 0xffffffffffffe) - g1;
+  h[2] = (f[2] + 0xffffffffffffe) - g2;
+  h[3] = (f[3] + 0xffffffffffffe) - g3;
+  h[4] = (f[4] + 0xffffffffffffe) - g4;
+}
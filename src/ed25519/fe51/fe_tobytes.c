@@ -0,0 +1,59 @@
+#include "../fe.h"
+
+static void store_8(unsigned char *out,crypto_uint64 in)
+{
+  out[0] = (unsigned char) in;
+  out[1] = (unsigned char) (in >> 8);
+  out[2] = (unsigned char) (in >> 16);
+  out[3] = (unsigned char) (in >> 24);
+  out[4] = (unsigned char) (in >> 32);
+  out[5] = (unsigned char) (in >> 40);
+  out[6] = (unsigned char) (in >> 48);
+  out[7] = (unsigned char) (in >> 56);
+}
+
+/*
+Preconditions:
+  h[i] bounded by 2^63.
+
+One carry pass leaves every limb below 2^51 except h0, which may exceed
+it by 19 * 2^12, so 0 <= h < 2p with p=2^255-19.
+Then q = floor(2^(-255)(h + 19)) is 1 if h >= p and 0 otherwise, and
+h + 19q - 2^255 q = h - pq is the fully reduced value.
+*/
+
+void fe_tobytes(unsigned char *s,const fe h)
+{
+  const crypto_uint64 mask = ((crypto_uint64) 1 << 51) - 1;
+  crypto_uint64 h0 = h[0];
+  crypto_uint64 h1 = h[1];
+  crypto_uint64 h2 = h[2];
+  crypto_uint64 h3 = h[3];
+  crypto_uint64 h4 = h[4];
+  crypto_uint64 q;
+
+  h1 += h0 >> 51; h0 &= mask;
+  h2 += h1 >> 51; h1 &= mask;
+  h3 += h2 >> 51; h2 &= mask;
+  h4 += h3 >> 51; h3 &= mask;
+  h0 += 19 * (h4 >> 51); h4 &= mask;
+
+  q = (h0 + 19) >> 51;
+  q = (h1 + q) >> 51;
+  q = (h2 + q) >> 51;
+  q = (h3 + q) >> 51;
+  q = (h4 + q) >> 51;
+
+  h0 += 19 * q;
+  h1 += h0 >> 51; h0 &= mask;
+  h2 += h1 >> 51; h1 &= mask;
+  h3 += h2 >> 51; h2 &= mask;
+  h4 += h3 >> 51; h3 &= mask;
+  /* Goal: Output h-2^255 q, which is between 0 and 2^255-20. */
+  h4 &= mask;
+
+  store_8(s,h0 | (h1 << 51));
+  store_8(s + 8,(h1 >> 13) | (h2 << 38));
+  store_8(s + 16,(h2 >> 26) | (h3 << 25));
+  store_8(s + 24,(h3 >> 39) | (h4 << 12));
+}
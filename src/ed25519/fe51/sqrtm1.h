@@ -0,0 +1 @@
+1718705420411056,234908883556509,2233514472574048,2117202627021982,765476049583133
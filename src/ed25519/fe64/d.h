@@ -0,0 +1 @@
+0x75eb4dca135978a3,0x00700a4d4141d8ab,0x8cc740797779e898,0x52036cee2b6ffe73
@@ -0,0 +1 @@
+0xebd69b9426b2f159,0x00e0149a8283b156,0x198e80f2eef3d130,0x2406d9dc56dffce7
@@ -0,0 +1,36 @@
+#include "../fe.h"
+#include "../crypto_uint128.h"
+
+/*
+h = f + g
+Can overlap h with f or g.
+
+A carry out of 2^256 is worth 38, since 2^256 = 38 mod q. Adding it back
+can carry once more, but only when h has wrapped to a small value, so
+the second fold cannot overflow.
+*/
+
+void fe_add(fe h,const fe f,const fe g)
+{
+  crypto_uint128 c;
+  crypto_uint64 h0;
+  crypto_uint64 h1;
+  crypto_uint64 h2;
+  crypto_uint64 h3;
+
+  c = (crypto_uint128) f[0] + g[0]; h0 = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) f[1] + g[1]; h1 = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) f[2] + g[2]; h2 = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) f[3] + g[3]; h3 = (crypto_uint64) c; c >>= 64;
+
+  c = (crypto_uint128) h0 + 38 * (crypto_uint64) c; h0 = (crypto_uint64) c; c >>= 64;
+  c += h1; h1 = (crypto_uint64) c; c >>= 64;
+  c += h2; h2 = (crypto_uint64) c; c >>= 64;
+  c += h3; h3 = (crypto_uint64) c; c >>= 64;
+  h0 += 38 * (crypto_uint64) c;
+
+  h[0] = h0;
+  h[1] = h1;
+  h[2] = h2;
+  h[3] = h3;
+}
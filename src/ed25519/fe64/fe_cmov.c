@@ -0,0 +1,21 @@
+#include "../fe.h"
+
+/*
+Replace (f,g) with (g,g) if b == 1;
+replace (f,g) with (f,g) if b == 0.
+
+Preconditions: b in {0,1}.
+*/
+
+void fe_cmov(fe f,const fe g,unsigned int b)
+{
+  crypto_uint64 mask = -(crypto_uint64) b;
+  crypto_uint64 x0 = (f[0] ^ g[0]) & mask;
+  crypto_uint64 x1 = (f[1] ^ g[1]) & mask;
+  crypto_uint64 x2 = (f[2] ^ g[2]) & mask;
+  crypto_uint64 x3 = (f[3] ^ g[3]) & mask;
+  f[0] ^= x0;
+  f[1] ^= x1;
+  f[2] ^= x2;
+  f[3] ^= x3;
+}
@@ -0,0 +1,27 @@
+#include "../fe.h"
+
+static crypto_uint64 load_8(const unsigned char *in)
+{
+  crypto_uint64 result;
+  result = (crypto_uint64) in[0];
+  result |= ((crypto_uint64) in[1]) << 8;
+  result |= ((crypto_uint64) in[2]) << 16;
+  result |= ((crypto_uint64) in[3]) << 24;
+  result |= ((crypto_uint64) in[4]) << 32;
+  result |= ((crypto_uint64) in[5]) << 40;
+  result |= ((crypto_uint64) in[6]) << 48;
+  result |= ((crypto_uint64) in[7]) << 56;
+  return result;
+}
+
+/*
+Ignores top bit of h.
+*/
+
+void fe_frombytes(fe h,const unsigned char *s)
+{
+  h[0] = load_8(s);
+  h[1] = load_8(s + 8);
+  h[2] = load_8(s + 16);
+  h[3] = load_8(s + 24) & 0x7fffffffffffffff;
+}
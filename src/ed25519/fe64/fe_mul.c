@@ -0,0 +1,123 @@
+#include "mulx.h"
+
+/*
+h = f * g
+Can overlap h with f or g.
+
+Preconditions:
+   f, g below 2^256.
+
+Postconditions:
+   h below 2^256.
+*/
+
+/*
+See mulx.h for the reduction and the choice of kernel.
+*/
+
+#ifdef HAVE_MULX
+/*
+Row i adds f[i] * g into t[i..i+4]; r8..r12 hold the five words of the
+running sum that row i touches, rotating by one register per row as the
+lowest word is finished and stored.
+*/
+#define FE64_MUL_MULX \
+  "movq 0(%[f]), %%rdx\n\t" \
+  "mulxq 0(%[g]), %%r8, %%r9\n\t" \
+  "mulxq 8(%[g]), %%rax, %%r10\n\t" \
+  "addq %%rax, %%r9\n\t" \
+  "mulxq 16(%[g]), %%rax, %%r11\n\t" \
+  "adcq %%rax, %%r10\n\t" \
+  "mulxq 24(%[g]), %%rax, %%r12\n\t" \
+  "adcq %%rax, %%r11\n\t" \
+  "adcq $0, %%r12\n\t" \
+  "movq %%r8, 0(%[t])\n\t" \
+  \
+  "movq 8(%[f]), %%rdx\n\t" \
+  "xorl %%r13d, %%r13d\n\t" \
+  "mulxq 0(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r9\n\t" \
+  "adoxq %%rcx, %%r10\n\t" \
+  "mulxq 8(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r10\n\t" \
+  "adoxq %%rcx, %%r11\n\t" \
+  "mulxq 16(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r11\n\t" \
+  "adoxq %%rcx, %%r12\n\t" \
+  "mulxq 24(%[g]), %%rax, %%r8\n\t" \
+  "adcxq %%rax, %%r12\n\t" \
+  "adoxq %%r13, %%r8\n\t" \
+  "adcxq %%r13, %%r8\n\t" \
+  "movq %%r9, 8(%[t])\n\t" \
+  \
+  "movq 16(%[f]), %%rdx\n\t" \
+  "xorl %%r13d, %%r13d\n\t" \
+  "mulxq 0(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r10\n\t" \
+  "adoxq %%rcx, %%r11\n\t" \
+  "mulxq 8(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r11\n\t" \
+  "adoxq %%rcx, %%r12\n\t" \
+  "mulxq 16(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r12\n\t" \
+  "adoxq %%rcx, %%r8\n\t" \
+  "mulxq 24(%[g]), %%rax, %%r9\n\t" \
+  "adcxq %%rax, %%r8\n\t" \
+  "adoxq %%r13, %%r9\n\t" \
+  "adcxq %%r13, %%r9\n\t" \
+  "movq %%r10, 16(%[t])\n\t" \
+  \
+  "movq 24(%[f]), %%rdx\n\t" \
+  "xorl %%r13d, %%r13d\n\t" \
+  "mulxq 0(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r11\n\t" \
+  "adoxq %%rcx, %%r12\n\t" \
+  "mulxq 8(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r12\n\t" \
+  "adoxq %%rcx, %%r8\n\t" \
+  "mulxq 16(%[g]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r8\n\t" \
+  "adoxq %%rcx, %%r9\n\t" \
+  "mulxq 24(%[g]), %%rax, %%r10\n\t" \
+  "adcxq %%rax, %%r9\n\t" \
+  "adoxq %%r13, %%r10\n\t" \
+  "adcxq %%r13, %%r10\n\t" \
+  "movq %%r11, 24(%[t])\n\t" \
+  "movq %%r12, 32(%[t])\n\t" \
+  "movq %%r8, 40(%[t])\n\t" \
+  "movq %%r9, 48(%[t])\n\t" \
+  "movq %%r10, 56(%[t])\n\t"
+#endif
+
+void fe_mul(fe h,const fe f,const fe g)
+{
+  crypto_uint64 t[8];
+  crypto_uint128 c;
+  int i;
+  int j;
+
+#ifdef HAVE_MULX
+  if (fe64_use_mulx()) {
+    __asm__ __volatile__(
+      FE64_MUL_MULX
+      FE64_REDUCE_MULX
+      :
+      : [h] "r" (h), [f] "r" (f), [g] "r" (g), [t] "r" (t)
+      : "rax", "rcx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "cc", "memory"
+    );
+    return;
+  }
+#endif
+
+  for (i = 0;i < 8;++i) t[i] = 0;
+  for (i = 0;i < 4;++i) {
+    c = 0;
+    for (j = 0;j < 4;++j) {
+      c += (crypto_uint128) f[i] * g[j] + t[i + j];
+      t[i + j] = (crypto_uint64) c;
+      c >>= 64;
+    }
+    t[i + 4] = (crypto_uint64) c;
+  }
+  fe64_reduce(h,t);
+}
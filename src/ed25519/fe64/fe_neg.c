@@ -0,0 +1,12 @@
+#include "../fe.h"
+
+/*
+h = -f
+*/
+
+void fe_neg(fe h,const fe f)
+{
+  fe zero;
+  fe_0(zero);
+  fe_sub(h,zero,f);
+}
@@ -0,0 +1,112 @@
+#include "mulx.h"
+
+/*
+h = f * f
+Can overlap h with f.
+
+Preconditions:
+   f below 2^256.
+
+Postconditions:
+   h below 2^256.
+*/
+
+/*
+See mulx.h for the reduction and the choice of kernel.
+*/
+
+#ifdef HAVE_MULX
+/*
+The six cross products f[i] f[j], i < j, are summed into r9..r14 and
+doubled into r9..r14 and rcx; the four squares f[i]^2 are then added
+along the diagonal, with r8 taking the lowest word.
+*/
+#define FE64_SQ_MULX \
+  "movq 0(%[f]), %%rdx\n\t" \
+  "mulxq 8(%[f]), %%r9, %%r10\n\t" \
+  "mulxq 16(%[f]), %%rax, %%r11\n\t" \
+  "addq %%rax, %%r10\n\t" \
+  "mulxq 24(%[f]), %%rax, %%r12\n\t" \
+  "adcq %%rax, %%r11\n\t" \
+  "movq 8(%[f]), %%rdx\n\t" \
+  "mulxq 24(%[f]), %%rax, %%r13\n\t" \
+  "adcq %%rax, %%r12\n\t" \
+  "adcq $0, %%r13\n\t" \
+  "movq 16(%[f]), %%rdx\n\t" \
+  "mulxq 24(%[f]), %%rax, %%r14\n\t" \
+  "addq %%rax, %%r13\n\t" \
+  "adcq $0, %%r14\n\t" \
+  "movq 8(%[f]), %%rdx\n\t" \
+  "mulxq 16(%[f]), %%rax, %%rcx\n\t" \
+  "addq %%rax, %%r11\n\t" \
+  "adcq %%rcx, %%r12\n\t" \
+  "adcq $0, %%r13\n\t" \
+  "adcq $0, %%r14\n\t" \
+  \
+  "xorl %%ecx, %%ecx\n\t" \
+  "addq %%r9, %%r9\n\t" \
+  "adcq %%r10, %%r10\n\t" \
+  "adcq %%r11, %%r11\n\t" \
+  "adcq %%r12, %%r12\n\t" \
+  "adcq %%r13, %%r13\n\t" \
+  "adcq %%r14, %%r14\n\t" \
+  "adcq %%rcx, %%rcx\n\t" \
+  \
+  "movq 0(%[f]), %%rdx\n\t" \
+  "mulxq %%rdx, %%r8, %%rax\n\t" \
+  "addq %%rax, %%r9\n\t" \
+  "movq 8(%[f]), %%rdx\n\t" \
+  "mulxq %%rdx, %%rax, %%rdx\n\t" \
+  "adcq %%rax, %%r10\n\t" \
+  "adcq %%rdx, %%r11\n\t" \
+  "movq 16(%[f]), %%rdx\n\t" \
+  "mulxq %%rdx, %%rax, %%rdx\n\t" \
+  "adcq %%rax, %%r12\n\t" \
+  "adcq %%rdx, %%r13\n\t" \
+  "movq 24(%[f]), %%rdx\n\t" \
+  "mulxq %%rdx, %%rax, %%rdx\n\t" \
+  "adcq %%rax, %%r14\n\t" \
+  "adcq %%rdx, %%rcx\n\t" \
+  \
+  "movq %%r8, 0(%[t])\n\t" \
+  "movq %%r9, 8(%[t])\n\t" \
+  "movq %%r10, 16(%[t])\n\t" \
+  "movq %%r11, 24(%[t])\n\t" \
+  "movq %%r12, 32(%[t])\n\t" \
+  "movq %%r13, 40(%[t])\n\t" \
+  "movq %%r14, 48(%[t])\n\t" \
+  "movq %%rcx, 56(%[t])\n\t"
+#endif
+
+void fe_sq(fe h,const fe f)
+{
+  crypto_uint64 t[8];
+  crypto_uint128 c;
+  int i;
+  int j;
+
+#ifdef HAVE_MULX
+  if (fe64_use_mulx()) {
+    __asm__ __volatile__(
+      FE64_SQ_MULX
+      FE64_REDUCE_MULX
+      :
+      : [h] "r" (h), [f] "r" (f), [t] "r" (t)
+      : "rax", "rcx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "cc", "memory"
+    );
+    return;
+  }
+#endif
+
+  for (i = 0;i < 8;++i) t[i] = 0;
+  for (i = 0;i < 4;++i) {
+    c = 0;
+    for (j = 0;j < 4;++j) {
+      c += (crypto_uint128) f[i] * f[j] + t[i + j];
+      t[i + j] = (crypto_uint64) c;
+      c >>= 64;
+    }
+    t[i + 4] = (crypto_uint64) c;
+  }
+  fe64_reduce(h,t);
+}
@@ -0,0 +1,18 @@
+#include "../fe.h"
+
+/*
+h = 2 * f * f
+Can overlap h with f.
+
+Preconditions:
+   f below 2^256.
+
+Postconditions:
+   h below 2^256.
+*/
+
+void fe_sq2(fe h,const fe f)
+{
+  fe_sq(h,f);
+  fe_add(h,h,h);
+}
@@ -0,0 +1,45 @@
+#include "../fe.h"
+
+/*
+h = f - g
+Can overlap h with f or g.
+
+A borrow from 2^256 is worth 38, since 2^256 = 38 mod q. Taking it off
+can borrow once more, but only when h has wrapped to a large value, so
+the second fold cannot underflow.
+*/
+
+void fe_sub(fe h,const fe f,const fe g)
+{
+  crypto_uint64 f0 = f[0];
+  crypto_uint64 f1 = f[1];
+  crypto_uint64 f2 = f[2];
+  crypto_uint64 f3 = f[3];
+  crypto_uint64 g0 = g[0];
+  crypto_uint64 g1 = g[1];
+  crypto_uint64 g2 = g[2];
+  crypto_uint64 g3 = g[3];
+  crypto_uint64 h0;
+  crypto_uint64 h1;
+  crypto_uint64 h2;
+  crypto_uint64 h3;
+  crypto_uint64 b;
+  crypto_uint64 t;
+
+  h0 = f0 - g0; b = f0 < g0;
+  t = f1 - g1; h1 = t - b; b = (f1 < g1) | (t < b);
+  t = f2 - g2; h2 = t - b; b = (f2 < g2) | (t < b);
+  t = f3 - g3; h3 = t - b; b = (f3 < g3) | (t < b);
+
+  t = 38 * b;
+  b = h0 < t; h0 -= t;
+  t = h1; h1 -= b; b = t < b;
+  t = h2; h2 -= b; b = t < b;
+  t = h3; h3 -= b; b = t < b;
+  h0 -= 38 * b;
+
+  h[0] = h0;
+  h[1] = h1;
+  h[2] = h2;
+  h[3] = h3;
+}
@@ -0,0 +1,54 @@
+#include "../fe.h"
+#include "../crypto_uint128.h"
+
+static void store_8(unsigned char *out,crypto_uint64 in)
+{
+  out[0] = (unsigned char) in;
+  out[1] = (unsigned char) (in >> 8);
+  out[2] = (unsigned char) (in >> 16);
+  out[3] = (unsigned char) (in >> 24);
+  out[4] = (unsigned char) (in >> 32);
+  out[5] = (unsigned char) (in >> 40);
+  out[6] = (unsigned char) (in >> 48);
+  out[7] = (unsigned char) (in >> 56);
+}
+
+/*
+h is any value below 2^256. Folding bit 255 back in as 19 leaves
+0 <= h < 2^255 + 19 < 2p with p=2^255-19.
+Then q = floor(2^(-255)(h + 19)) is 1 if h >= p and 0 otherwise, and
+h + 19q - 2^255 q = h - pq is the fully reduced value.
+*/
+
+void fe_tobytes(unsigned char *s,const fe h)
+{
+  crypto_uint128 c;
+  crypto_uint64 h0;
+  crypto_uint64 h1;
+  crypto_uint64 h2;
+  crypto_uint64 h3;
+  crypto_uint64 q;
+
+  c = (crypto_uint128) h[0] + 19 * (h[3] >> 63); h0 = (crypto_uint64) c; c >>= 64;
+  c += h[1]; h1 = (crypto_uint64) c; c >>= 64;
+  c += h[2]; h2 = (crypto_uint64) c; c >>= 64;
+  c += h[3] & 0x7fffffffffffffff; h3 = (crypto_uint64) c;
+
+  c = (crypto_uint128) h0 + 19; c >>= 64;
+  c += h1; c >>= 64;
+  c += h2; c >>= 64;
+  c += h3;
+  q = (crypto_uint64) c >> 63;
+
+  c = (crypto_uint128) h0 + 19 * q; h0 = (crypto_uint64) c; c >>= 64;
+  c += h1; h1 = (crypto_uint64) c; c >>= 64;
+  c += h2; h2 = (crypto_uint64) c; c >>= 64;
+  c += h3; h3 = (crypto_uint64) c;
+  /* Goal: Output h-2^255 q, which is between 0 and 2^255-20. */
+  h3 &= 0x7fffffffffffffff;
+
+  store_8(s,h0);
+  store_8(s + 8,h1);
+  store_8(s + 16,h2);
+  store_8(s + 24,h3);
+}
@@ -0,0 +1,96 @@
+#ifndef FE64_MULX_H
+#define FE64_MULX_H
+
+#include "../fe.h"
+#include "../cpu.h"
+#include "../crypto_uint128.h"
+
+/*
+Shared by fe_mul.c and fe_sq.c.
+
+The 512-bit product t of two field elements is reduced as
+t[0..3] + 38 t[4..7], since 2^256 = 38 mod q. That leaves a carry of a
+few bits above 2^256, which is folded in as 38 times itself; a last
+carry out of that can only leave a small value, so adding 38 for it
+cannot overflow. Results are below 2^256 but not fully reduced.
+
+On x86-64 CPUs with BMI2 and ADX both the product and the reduction run
+as inline assembly. MULX multiplies without touching the flags, so
+within one row of partial products ADCX adds the low halves on the carry
+flag while ADOX adds the high halves on the overflow flag, two carry
+chains the CPU can run side by side. Other CPUs use the portable code;
+the choice is made once per process.
+*/
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define HAVE_MULX
+
+/* t in memory to h: rdx = 38, r13 = 0, r8..r11 accumulate h */
+#define FE64_REDUCE_MULX \
+  "movq $38, %%rdx\n\t" \
+  "xorl %%r13d, %%r13d\n\t" \
+  "movq 0(%[t]), %%r8\n\t" \
+  "movq 8(%[t]), %%r9\n\t" \
+  "movq 16(%[t]), %%r10\n\t" \
+  "movq 24(%[t]), %%r11\n\t" \
+  "mulxq 32(%[t]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r8\n\t" \
+  "adoxq %%rcx, %%r9\n\t" \
+  "mulxq 40(%[t]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r9\n\t" \
+  "adoxq %%rcx, %%r10\n\t" \
+  "mulxq 48(%[t]), %%rax, %%rcx\n\t" \
+  "adcxq %%rax, %%r10\n\t" \
+  "adoxq %%rcx, %%r11\n\t" \
+  "mulxq 56(%[t]), %%rax, %%r12\n\t" \
+  "adcxq %%rax, %%r11\n\t" \
+  "adoxq %%r13, %%r12\n\t" \
+  "adcxq %%r13, %%r12\n\t" \
+  "imulq %%rdx, %%r12\n\t" \
+  "addq %%r12, %%r8\n\t" \
+  "adcq %%r13, %%r9\n\t" \
+  "adcq %%r13, %%r10\n\t" \
+  "adcq %%r13, %%r11\n\t" \
+  "cmovcq %%rdx, %%r13\n\t" \
+  "addq %%r13, %%r8\n\t" \
+  "movq %%r8, 0(%[h])\n\t" \
+  "movq %%r9, 8(%[h])\n\t" \
+  "movq %%r10, 16(%[h])\n\t" \
+  "movq %%r11, 24(%[h])\n\t"
+
+static int use_mulx = -1;
+
+static int fe64_use_mulx(void)
+{
+  const int need = ED25519_CPU_BMI2 | ED25519_CPU_ADX;
+  if (use_mulx < 0) use_mulx = (ed25519_cpu_features() & need) == need;
+  return use_mulx;
+}
+#endif
+
+static void fe64_reduce(fe h,const crypto_uint64 *t)
+{
+  crypto_uint128 c;
+  crypto_uint64 h0;
+  crypto_uint64 h1;
+  crypto_uint64 h2;
+  crypto_uint64 h3;
+
+  c = (crypto_uint128) t[4] * 38 + t[0]; h0 = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) t[5] * 38 + t[1]; h1 = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) t[6] * 38 + t[2]; h2 = (crypto_uint64) c; c >>= 64;
+  c += (crypto_uint128) t[7] * 38 + t[3]; h3 = (crypto_uint64) c; c >>= 64;
+
+  c = (crypto_uint128) h0 + 38 * (crypto_uint64) c; h0 = (crypto_uint64) c; c >>= 64;
+  c += h1; h1 = (crypto_uint64) c; c >>= 64;
+  c += h2; h2 = (crypto_uint64) c; c >>= 64;
+  c += h3; h3 = (crypto_uint64) c; c >>= 64;
+  h0 += 38 * (crypto_uint64) c;
+
+  h[0] = h0;
+  h[1] = h1;
+  h[2] = h2;
+  h[3] = h3;
+}
+
+#endif
@@ -0,0 +1 @@
+0xc4ee1b274a0ea0b0,0x2f431806ad2fe478,0x2b4d00993dfbd7a7,0x2b8324804fc1df0b
@@ -1,7 +1,23 @@
 #include "fe.h"
+#ifdef ED25519_SAFEGCD
+#include "safegcd.h"
+#endif
+
+/*
+With ED25519_SAFEGCD the inverse comes from the divstep inversion in
+safegcd.c, run on the canonical encoding of z, in place of the
+pow225521.h chain of 254 squarings and 11 multiplications.
+*/
 
 void fe_invert(fe out,const fe z)
 {
+#ifdef ED25519_SAFEGCD
+  unsigned char s[32];
+
+  fe_tobytes(s,z);
+  safegcd_invert(s,s);
+  fe_frombytes(out,s);
+#else
   fe t0;
   fe t1;
   fe t2;
@@ -9,6 +25,7 @@ void fe_invert(fe out,const fe z)
   int i;
 
 #include "pow225521.h"
+#endif
 
   return;
 }
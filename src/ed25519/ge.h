@@ -15,6 +15,7 @@ Representations:
   ge_precomp (Duif): (y+x,y-x,2dxy)
 */
 
+#include <stddef.h>
 #include "fe.h"
 
 typedef struct {
@@ -50,29 +51,38 @@ typedef struct {
   fe T2d;
 } ge_cached;
 
-#define ge_frombytes_negate_vartime crypto_sign_ed25519_ref10_ge_frombytes_negate_vartime
-#define ge_tobytes crypto_sign_ed25519_ref10_ge_tobytes
-#define ge_p3_tobytes crypto_sign_ed25519_ref10_ge_p3_tobytes
-
-#define ge_p2_0 crypto_sign_ed25519_ref10_ge_p2_0
-#define ge_p3_0 crypto_sign_ed25519_ref10_ge_p3_0
-#define ge_precomp_0 crypto_sign_ed25519_ref10_ge_precomp_0
-#define ge_p3_to_p2 crypto_sign_ed25519_ref10_ge_p3_to_p2
-#define ge_p3_to_cached crypto_sign_ed25519_ref10_ge_p3_to_cached
-#define ge_p1p1_to_p2 crypto_sign_ed25519_ref10_ge_p1p1_to_p2
-#define ge_p1p1_to_p3 crypto_sign_ed25519_ref10_ge_p1p1_to_p3
-#define ge_p2_dbl crypto_sign_ed25519_ref10_ge_p2_dbl
-#define ge_p3_dbl crypto_sign_ed25519_ref10_ge_p3_dbl
-
-#define ge_madd crypto_sign_ed25519_ref10_ge_madd
-#define ge_msub crypto_sign_ed25519_ref10_ge_msub
-#define ge_add crypto_sign_ed25519_ref10_ge_add
-#define ge_sub crypto_sign_ed25519_ref10_ge_sub
-#define ge_scalarmult_base crypto_sign_ed25519_ref10_ge_scalarmult_base
-#define ge_double_scalarmult_vartime crypto_sign_ed25519_ref10_ge_double_scalarmult_vartime
+#define ge_frombytes_negate_vartime ED25519_NAME(ge_frombytes_negate_vartime)
+#define ge_tobytes ED25519_NAME(ge_tobytes)
+#define ge_p3_tobytes ED25519_NAME(ge_p3_tobytes)
+#define ge_p3_batch_tobytes ED25519_NAME(ge_p3_batch_tobytes)
+
+#define ge_p2_0 ED25519_NAME(ge_p2_0)
+#define ge_p3_0 ED25519_NAME(ge_p3_0)
+#define ge_precomp_0 ED25519_NAME(ge_precomp_0)
+#define ge_p3_to_p2 ED25519_NAME(ge_p3_to_p2)
+#define ge_p3_to_cached ED25519_NAME(ge_p3_to_cached)
+#define ge_p1p1_to_p2 ED25519_NAME(ge_p1p1_to_p2)
+#define ge_p1p1_to_p3 ED25519_NAME(ge_p1p1_to_p3)
+#define ge_p2_dbl ED25519_NAME(ge_p2_dbl)
+#define ge_p3_dbl ED25519_NAME(ge_p3_dbl)
+
+#define ge_madd ED25519_NAME(ge_madd)
+#define ge_msub ED25519_NAME(ge_msub)
+#define ge_add ED25519_NAME(ge_add)
+#define ge_sub ED25519_NAME(ge_sub)
+#define ge_scalarmult_base ED25519_NAME(ge_scalarmult_base)
+#define ge_scalarmult_base_x4 ED25519_NAME(ge_scalarmult_base_x4)
+#define ge_base ED25519_NAME(ge_base)
+#define ge_double_scalarmult_vartime ED25519_NAME(ge_double_scalarmult_vartime)
+#define ge_double_scalarmult_precomp_vartime ED25519_NAME(ge_double_scalarmult_precomp_vartime)
+#define ge_precomp_odd_multiples ED25519_NAME(ge_precomp_odd_multiples)
+#define ge_multi_scalarmult_vartime ED25519_NAME(ge_multi_scalarmult_vartime)
+#define ge_multi_scalarmult_vartime_scratch ED25519_NAME(ge_multi_scalarmult_vartime_scratch)
+#define ge_multi_scalarmult_scratch_bytes ED25519_NAME(ge_multi_scalarmult_scratch_bytes)
 
 extern void ge_tobytes(unsigned char *,const ge_p2 *);
 extern void ge_p3_tobytes(unsigned char *,const ge_p3 *);
+extern void ge_p3_batch_tobytes(unsigned char *,const ge_p3 *,int);
 extern int ge_frombytes_negate_vartime(ge_p3 *,const unsigned char *);
 
 extern void ge_p2_0(ge_p2 *);
@@ -90,6 +100,14 @@ extern void ge_msub(ge_p1p1 *,const ge_p3 *,const ge_precomp *);
 extern void ge_add(ge_p1p1 *,const ge_p3 *,const ge_cached *);
 extern void ge_sub(ge_p1p1 *,const ge_p3 *,const ge_cached *);
 extern void ge_scalarmult_base(ge_p3 *,const unsigned char *);
+extern void ge_scalarmult_base_x4(ge_p3 *,const unsigned char *);
 extern void ge_double_scalarmult_vartime(ge_p2 *,const unsigned char *,const ge_p3 *,const unsigned char *);
+extern void ge_double_scalarmult_precomp_vartime(ge_p2 *,const unsigned char *,const ge_precomp *,const unsigned char *);
+extern void ge_precomp_odd_multiples(ge_precomp *,const ge_p3 *,int);
+extern int ge_multi_scalarmult_vartime(ge_p3 *,const unsigned char *,const ge_p3 *,size_t);
+extern void ge_multi_scalarmult_vartime_scratch(ge_p3 *,const unsigned char *,const ge_p3 *,size_t,void *);
+extern size_t ge_multi_scalarmult_scratch_bytes(size_t);
+
+extern const ge_precomp ge_base[32][8];
 
 #endif
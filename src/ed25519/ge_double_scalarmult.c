@@ -1,6 +1,13 @@
 #include "ge.h"
+#include "cpu.h"
+#include "fe4.h"
 
-static void slide(signed char *r,const unsigned char *a)
+/*
+Signed sliding window digits of a: each nonzero r[i] is odd and at most
+bound in absolute value.
+*/
+
+static void slide(signed char *r,const unsigned char *a,int bound)
 {
   int i;
   int b;
@@ -11,11 +18,11 @@ static void slide(signed char *r,const unsigned char *a)
 
   for (i = 0;i < 256;++i)
     if (r[i]) {
-      for (b = 1;b <= 6 && i + b < 256;++b) {
+      for (b = 1;b <= 7 && i + b < 256;++b) {
         if (r[i + b]) {
-          if (r[i] + (r[i + b] << b) <= 15) {
+          if (r[i] + (r[i + b] << b) <= bound) {
             r[i] += r[i + b] << b; r[i + b] = 0;
-          } else if (r[i] - (r[i + b] << b) >= -15) {
+          } else if (r[i] - (r[i + b] << b) >= -bound) {
             r[i] -= r[i + b] << b;
             for (k = i + b;k < 256;++k) {
               if (!r[k]) {
@@ -33,9 +40,161 @@ static void slide(signed char *r,const unsigned char *a)
 }
 
 static ge_precomp Bi[8] = {
+#if defined(ED25519_FE64)
+#include "fe64/base2.h"
+#elif defined(ED25519_FE51)
+#include "fe51/base2.h"
+#else
 #include "base2.h"
+#endif
 } ;
 
+/*
+The radix 2^51 and 2^64 fields multiply faster with 64-bit products than
+four 32-bit lanes do, so only the ref10 field takes the path below.
+*/
+#if defined(HAVE_AVX2_X4) && !defined(ED25519_FE51) && !defined(ED25519_FE64)
+#define HAVE_AVX2_DOUBLE
+#endif
+
+#ifdef HAVE_AVX2_DOUBLE
+/*
+ge_double_scalarmult_vartime with the four coordinates X,Y,Z,T of one
+point in the four lanes of a fe4 (see fe4.h), after the 4-way parallel
+formulas of Hisil, Wong, Carter and Dawson. A doubling is one fe4_sq and
+one fe4_mul, an addition two fe4_mul, against seven and eight field
+multiplications in the scalar code. Lane shuffles line the operands up in
+between, and every lane computes what ge_p2_dbl.h, ge_add.h and
+ge_p1p1_to_p3.c compute, with the same bounds.
+
+Addends are kept as (Y+X,Y-X,2Z,2dT), so the first product of an addition
+yields A, B, 2*Z1*Z2 and C of ge_add.h at once. Bi4 holds Bi in that
+layout with Z = 1, one row of four lanes per limb.
+*/
+
+static const long long Bi4[8][10][4] = {
+#include "base2_x4.h"
+} ;
+
+static const crypto_int32 d2_10[10] = {
+#include "d2.h"
+} ;
+
+#define LANES(a,b,c,d) _mm256_set_epi64x(-(d),-(c),-(b),-(a))
+
+/* (X,Y,Z,T) from ge_p1p1 lanes (X,Y,Z,T) */
+static AVX2 void ge4_p1p1_to_p3(fe4 *p,const fe4 *r)
+{
+  fe4 f;
+  fe4 g;
+  fe4_shuffle(&f,r,fe4_lanes(0,1,2,0));
+  fe4_shuffle(&g,r,fe4_lanes(3,2,3,1));
+  fe4_mul(p,&f,&g,0);
+}
+
+/* p = 2 * p */
+static AVX2 void ge4_dbl(fe4 *p)
+{
+  fe4 s;
+  fe4 t;
+  fe4 u;
+  fe4_shuffle(&s,p,fe4_lanes(0,1,2,0));
+  fe4_shuffle(&t,p,fe4_lanes(1,1,1,1));
+  fe4_addsub(&s,&s,&t,LANES(0,0,0,1),LANES(0,0,0,0)); /* X,Y,Z,X+Y */
+  fe4_sq(&s,&s,LANES(0,0,1,0)); /* XX,YY,B,AA */
+  fe4_shuffle(&t,&s,fe4_lanes(3,1,1,2));
+  fe4_shuffle(&u,&s,fe4_lanes(1,0,0,1));
+  fe4_addsub(&t,&t,&u,LANES(1,1,1,1),LANES(1,0,1,1)); /* AA-YY,YY+XX,YY-XX,B-YY */
+  fe4_shuffle(&u,&s,fe4_lanes(0,0,0,0));
+  fe4_addsub(&t,&t,&u,LANES(1,0,0,1),LANES(1,0,0,0)); /* X3,Y3,Z3,T3 */
+  ge4_p1p1_to_p3(p,&t);
+}
+
+/* p = p + q, or p - q if sub */
+static AVX2 void ge4_add(fe4 *p,const fe4 *q,int sub)
+{
+  fe4 u;
+  fe4 v;
+  fe4 neg;
+  if (sub) {
+    /* -q = (Y-X,Y+X,2Z,-2dT) */
+    fe4_0(&u);
+    fe4_shuffle(&neg,q,fe4_lanes(1,0,2,3));
+    fe4_addsub(&neg,&u,&neg,LANES(1,1,1,1),LANES(0,0,0,1));
+    q = &neg;
+  }
+  fe4_shuffle(&u,p,fe4_lanes(1,1,2,3));
+  fe4_shuffle(&v,p,fe4_lanes(0,0,0,0));
+  fe4_addsub(&u,&u,&v,LANES(1,1,0,0),LANES(0,1,0,0)); /* Y+X,Y-X,Z,T */
+  fe4_mul(&u,&u,q,0); /* A,B,D,C */
+  fe4_shuffle(&v,&u,fe4_lanes(1,1,3,3));
+  fe4_shuffle(&u,&u,fe4_lanes(0,0,2,2));
+  fe4_addsub(&u,&u,&v,LANES(1,1,1,1),LANES(1,0,0,1)); /* X3,Y3,Z3,T3 */
+  ge4_p1p1_to_p3(p,&u);
+}
+
+static AVX2 void ge4_load(fe4 *h,const long long (*f)[4])
+{
+  int i;
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_loadu_si256((const __m256i *) f[i]);
+}
+
+static AVX2 void double_scalarmult_avx2(ge_p2 *r,const signed char *aslide,const ge_p3 *A,const signed char *bslide,int i)
+{
+  fe4 Ai[8]; /* A,3A,5A,7A,9A,11A,13A,15A */
+  fe4 A2;
+  fe4 scale;
+  fe4 p;
+  fe4 q;
+  fe out[4];
+  int j;
+
+  for (j = 0;j < 10;++j) scale.v[j] = _mm256_set_epi64x(d2_10[j],0,0,0);
+  scale.v[0] = _mm256_add_epi64(scale.v[0],_mm256_set_epi64x(0,2,1,1));
+
+  fe4_insert(&p,A->X,A->Y,A->Z,A->T);
+  A2 = p;
+  ge4_dbl(&A2);
+  for (j = 0;j < 8;++j) {
+    /* (Y+X,Y-X,2Z,2dT) */
+    fe4_shuffle(&Ai[j],&p,fe4_lanes(1,1,2,3));
+    fe4_shuffle(&q,&p,fe4_lanes(0,0,0,0));
+    fe4_addsub(&Ai[j],&Ai[j],&q,LANES(1,1,0,0),LANES(0,1,0,0));
+    fe4_mul(&Ai[j],&Ai[j],&scale,0);
+    if (j < 7) {
+      p = A2;
+      ge4_add(&p,&Ai[j],0);
+    }
+  }
+
+  fe4_0(&p);
+  p.v[0] = _mm256_set_epi64x(0,1,1,0);
+
+  for (;i >= 0;--i) {
+    ge4_dbl(&p);
+
+    if (aslide[i] > 0) {
+      ge4_add(&p,&Ai[aslide[i]/2],0);
+    } else if (aslide[i] < 0) {
+      ge4_add(&p,&Ai[(-aslide[i])/2],1);
+    }
+
+    if (bslide[i] > 0) {
+      ge4_load(&q,Bi4[bslide[i]/2]);
+      ge4_add(&p,&q,0);
+    } else if (bslide[i] < 0) {
+      ge4_load(&q,Bi4[(-bslide[i])/2]);
+      ge4_add(&p,&q,1);
+    }
+  }
+
+  fe4_extract(out,&p);
+  fe_copy(r->X,out[0]);
+  fe_copy(r->Y,out[1]);
+  fe_copy(r->Z,out[2]);
+}
+#endif
+
 /*
 r = a * A + b * B
 where a = a[0]+256*a[1]+...+256^31 a[31].
@@ -53,8 +212,18 @@ void ge_double_scalarmult_vartime(ge_p2 *r,const unsigned char *a,const ge_p3 *A
   ge_p3 A2;
   int i;
 
-  slide(aslide,a);
-  slide(bslide,b);
+  slide(aslide,a,15);
+  slide(bslide,b,15);
+
+#ifdef HAVE_AVX2_DOUBLE
+  if (ed25519_cpu_features() & ED25519_CPU_AVX2) {
+    for (i = 255;i >= 0;--i) {
+      if (aslide[i] || bslide[i]) break;
+    }
+    double_scalarmult_avx2(r,aslide,A,bslide,i);
+    return;
+  }
+#endif
 
   ge_p3_to_cached(&Ai[0],A);
   ge_p3_dbl(&t,A); ge_p1p1_to_p3(&A2,&t);
@@ -94,3 +263,49 @@ void ge_double_scalarmult_vartime(ge_p2 *r,const unsigned char *a,const ge_p3 *A
     ge_p1p1_to_p2(r,&t);
   }
 }
+
+/*
+r = a * A + b * B
+where Ai holds A,3A,5A,...,63A as ge_precomp, e.g. from ge_precomp_odd_multiples.
+The wider window means fewer additions for a, and each one is a ge_madd.
+*/
+
+void ge_double_scalarmult_precomp_vartime(ge_p2 *r,const unsigned char *a,const ge_precomp *Ai,const unsigned char *b)
+{
+  signed char aslide[256];
+  signed char bslide[256];
+  ge_p1p1 t;
+  ge_p3 u;
+  int i;
+
+  slide(aslide,a,63);
+  slide(bslide,b,15);
+
+  ge_p2_0(r);
+
+  for (i = 255;i >= 0;--i) {
+    if (aslide[i] || bslide[i]) break;
+  }
+
+  for (;i >= 0;--i) {
+    ge_p2_dbl(&t,r);
+
+    if (aslide[i] > 0) {
+      ge_p1p1_to_p3(&u,&t);
+      ge_madd(&t,&u,&Ai[aslide[i]/2]);
+    } else if (aslide[i] < 0) {
+      ge_p1p1_to_p3(&u,&t);
+      ge_msub(&t,&u,&Ai[(-aslide[i])/2]);
+    }
+
+    if (bslide[i] > 0) {
+      ge_p1p1_to_p3(&u,&t);
+      ge_madd(&t,&u,&Bi[bslide[i]/2]);
+    } else if (bslide[i] < 0) {
+      ge_p1p1_to_p3(&u,&t);
+      ge_msub(&t,&u,&Bi[(-bslide[i])/2]);
+    }
+
+    ge_p1p1_to_p2(r,&t);
+  }
+}
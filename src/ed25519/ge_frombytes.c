@@ -1,11 +1,23 @@
 #include "ge.h"
 
 static const fe d = {
+#if defined(ED25519_FE64)
+#include "fe64/d.h"
+#elif defined(ED25519_FE51)
+#include "fe51/d.h"
+#else
 #include "d.h"
+#endif
 } ;
 
 static const fe sqrtm1 = {
+#if defined(ED25519_FE64)
+#include "fe64/sqrtm1.h"
+#elif defined(ED25519_FE51)
+#include "fe51/sqrtm1.h"
+#else
 #include "sqrtm1.h"
+#endif
 } ;
 
 int ge_frombytes_negate_vartime(ge_p3 *h,const unsigned char *s)
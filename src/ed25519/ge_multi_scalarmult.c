@@ -0,0 +1,192 @@
+#include <stdlib.h>
+#include "ge.h"
+
+/*
+Signed radix 2^c digits of a, least significant first.
+Each digit is in [-2^(c-1),2^(c-1)).
+
+Preconditions:
+  a < 2^253
+  windows >= ceil(253/c) + 1
+*/
+
+static void recode(signed short *e,const unsigned char *a,int c,int windows)
+{
+  int half = 1 << (c - 1);
+  int carry = 0;
+  int j;
+  int bit;
+  int v;
+
+  for (j = 0;j < windows;++j) {
+    v = 0;
+    for (bit = j * c + c - 1;bit >= j * c;--bit) {
+      v <<= 1;
+      if (bit < 256) v |= (a[bit >> 3] >> (bit & 7)) & 1;
+    }
+    v += carry;
+    carry = v >= half;
+    e[j] = v - (carry << c);
+  }
+}
+
+static void ge_p3_neg(ge_p3 *r,const ge_p3 *p)
+{
+  fe_neg(r->X,p->X);
+  fe_copy(r->Y,p->Y);
+  fe_copy(r->Z,p->Z);
+  fe_neg(r->T,p->T);
+}
+
+/*
+Bucket window width minimizing windows * (points + buckets) additions.
+*/
+
+static int window_width(size_t n)
+{
+  int c;
+  int best = 2;
+  double cost;
+  double bestcost = 0;
+
+  for (c = 2;c <= 12;++c) {
+    cost = (double) ((253 + c - 1) / c + 1) * ((double) n + (double) (1 << c));
+    if (c == 2 || cost < bestcost) {
+      best = c;
+      bestcost = cost;
+    }
+  }
+  return best;
+}
+
+/* byte counts rounded up so each scratch array stays aligned */
+#define ROUND16(x) (((x) + 15) & ~(size_t) 15)
+
+/*
+Bytes of scratch memory ge_multi_scalarmult_vartime_scratch needs for n points.
+*/
+
+size_t ge_multi_scalarmult_scratch_bytes(size_t n)
+{
+  int c = window_width(n);
+  int windows = (253 + c - 1) / c + 1;
+  size_t nbuckets = (size_t) 1 << (c - 1);
+
+  return ROUND16(n * windows * sizeof(signed short))
+       + ROUND16(n * sizeof(ge_cached))
+       + ROUND16(nbuckets * sizeof(ge_p3))
+       + ROUND16(nbuckets);
+}
+
+/*
+r = a[0] * A[0] + a[1] * A[1] + ... + a[n-1] * A[n-1]
+using Pippenger's bucket method with signed digits.
+where a[i] is 32 bytes little endian at a + 32 * i.
+
+Preconditions:
+  each a[i] < 2^253
+  scratch: 16 byte aligned, ge_multi_scalarmult_scratch_bytes(n) long
+*/
+
+void ge_multi_scalarmult_vartime_scratch(ge_p3 *r,const unsigned char *a,const ge_p3 *A,size_t n,void *scratch)
+{
+  int c = window_width(n);
+  int windows = (253 + c - 1) / c + 1;
+  int nbuckets = 1 << (c - 1);
+  unsigned char *next = (unsigned char *) scratch;
+  signed short *e;
+  ge_cached *Ac;
+  ge_p3 *bucket;
+  unsigned char *used;
+  ge_p3 sum;
+  ge_p3 total;
+  ge_cached t;
+  ge_p1p1 p;
+  ge_p2 q;
+  size_t i;
+  int j;
+  int k;
+  int d;
+  int first;
+
+  e = (signed short *) next; next += ROUND16(n * windows * sizeof(signed short));
+  Ac = (ge_cached *) next; next += ROUND16(n * sizeof(ge_cached));
+  bucket = (ge_p3 *) next; next += ROUND16(nbuckets * sizeof(ge_p3));
+  used = next;
+
+  for (i = 0;i < n;++i) {
+    recode(e + i * windows,a + 32 * i,c,windows);
+    ge_p3_to_cached(&Ac[i],&A[i]);
+  }
+
+  ge_p3_0(r);
+  first = 1;
+  for (j = windows - 1;j >= 0;--j) {
+    if (!first) {
+      ge_p3_to_p2(&q,r);
+      for (k = 0;k < c - 1;++k) {
+        ge_p2_dbl(&p,&q); ge_p1p1_to_p2(&q,&p);
+      }
+      ge_p2_dbl(&p,&q); ge_p1p1_to_p3(r,&p);
+    }
+
+    for (k = 0;k < nbuckets;++k) used[k] = 0;
+    for (i = 0;i < n;++i) {
+      d = e[i * windows + j];
+      if (d > 0) {
+        k = d - 1;
+        if (used[k]) {
+          ge_add(&p,&bucket[k],&Ac[i]); ge_p1p1_to_p3(&bucket[k],&p);
+        } else {
+          bucket[k] = A[i];
+          used[k] = 1;
+        }
+      } else if (d < 0) {
+        k = -d - 1;
+        if (used[k]) {
+          ge_sub(&p,&bucket[k],&Ac[i]); ge_p1p1_to_p3(&bucket[k],&p);
+        } else {
+          ge_p3_neg(&bucket[k],&A[i]);
+          used[k] = 1;
+        }
+      }
+    }
+
+    /* total = sum of (k+1) * bucket[k], by running sums from the top down */
+    for (k = nbuckets - 1;k >= 0 && !used[k];--k) ;
+    if (k < 0) continue;
+    sum = bucket[k];
+    total = sum;
+    for (--k;k >= 0;--k) {
+      if (used[k]) {
+        ge_p3_to_cached(&t,&bucket[k]);
+        ge_add(&p,&sum,&t); ge_p1p1_to_p3(&sum,&p);
+      }
+      ge_p3_to_cached(&t,&sum);
+      ge_add(&p,&total,&t); ge_p1p1_to_p3(&total,&p);
+    }
+
+    if (first) {
+      *r = total;
+      first = 0;
+    } else {
+      ge_p3_to_cached(&t,&total);
+      ge_add(&p,r,&t); ge_p1p1_to_p3(r,&p);
+    }
+  }
+}
+
+/*
+Same as ge_multi_scalarmult_vartime_scratch, with malloc'd scratch memory.
+Returns 0, or -1 if scratch memory could not be allocated.
+*/
+
+int ge_multi_scalarmult_vartime(ge_p3 *r,const unsigned char *a,const ge_p3 *A,size_t n)
+{
+  void *scratch = malloc(ge_multi_scalarmult_scratch_bytes(n));
+
+  if (!scratch) return -1;
+  ge_multi_scalarmult_vartime_scratch(r,a,A,n,scratch);
+  free(scratch);
+  return 0;
+}
@@ -5,7 +5,13 @@ r = p
 */
 
 static const fe d2 = {
+#if defined(ED25519_FE64)
+#include "fe64/d2.h"
+#elif defined(ED25519_FE51)
+#include "fe51/d2.h"
+#else
 #include "d2.h"
+#endif
 } ;
 
 extern void ge_p3_to_cached(ge_cached *r,const ge_p3 *p)
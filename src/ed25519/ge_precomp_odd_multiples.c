@@ -0,0 +1,60 @@
+#include "ge.h"
+
+static const fe d2 = {
+#if defined(ED25519_FE64)
+#include "fe64/d2.h"
+#elif defined(ED25519_FE51)
+#include "fe51/d2.h"
+#else
+#include "d2.h"
+#endif
+} ;
+
+/*
+Ai[i] = (2i+1) * A for i = 0..n-1, in affine ge_precomp form.
+The Z coordinates are inverted together with Montgomery's trick,
+so the table costs a single fe_invert.
+
+Preconditions:
+  1 <= n <= 64
+*/
+
+void ge_precomp_odd_multiples(ge_precomp *Ai,const ge_p3 *A,int n)
+{
+  ge_p3 P[64];
+  fe prod[64];
+  ge_cached A2c;
+  ge_p1p1 t;
+  ge_p3 A2;
+  fe inv;
+  fe zinv;
+  fe x;
+  fe y;
+  int i;
+
+  P[0] = *A;
+  ge_p3_dbl(&t,A); ge_p1p1_to_p3(&A2,&t);
+  ge_p3_to_cached(&A2c,&A2);
+  for (i = 1;i < n;++i) {
+    ge_add(&t,&P[i - 1],&A2c); ge_p1p1_to_p3(&P[i],&t);
+  }
+
+  fe_copy(prod[0],P[0].Z);
+  for (i = 1;i < n;++i) fe_mul(prod[i],prod[i - 1],P[i].Z);
+  fe_invert(inv,prod[n - 1]);
+
+  for (i = n - 1;i >= 0;--i) {
+    if (i > 0) {
+      fe_mul(zinv,inv,prod[i - 1]);
+      fe_mul(inv,inv,P[i].Z);
+    } else {
+      fe_copy(zinv,inv);
+    }
+    fe_mul(x,P[i].X,zinv);
+    fe_mul(y,P[i].Y,zinv);
+    fe_add(Ai[i].yplusx,y,x);
+    fe_sub(Ai[i].yminusx,y,x);
+    fe_mul(Ai[i].xy2d,x,y);
+    fe_mul(Ai[i].xy2d,Ai[i].xy2d,d2);
+  }
+}
@@ -19,16 +19,22 @@ static unsigned char negative(signed char b)
   return x;
 }
 
-static void cmov(ge_precomp *t,ge_precomp *u,unsigned char b)
+static void cmov(ge_precomp *t,const ge_precomp *u,unsigned char b)
 {
   fe_cmov(t->yplusx,u->yplusx,b);
   fe_cmov(t->yminusx,u->yminusx,b);
   fe_cmov(t->xy2d,u->xy2d,b);
 }
 
-/* base[i][j] = (j+1)*256^i*B */
-static ge_precomp base[32][8] = {
+/* ge_base[i][j] = (j+1)*256^i*B */
+const ge_precomp ge_base[32][8] = {
+#if defined(ED25519_FE64)
+#include "fe64/base.h"
+#elif defined(ED25519_FE51)
+#include "fe51/base.h"
+#else
 #include "base.h"
+#endif
 } ;
 
 static void select(ge_precomp *t,int pos,signed char b)
@@ -38,14 +44,14 @@ static void select(ge_precomp *t,int pos,signed char b)
   unsigned char babs = b - (((-bnegative) & b) << 1);
 
   ge_precomp_0(t);
-  cmov(t,&base[pos][0],equal(babs,1));
-  cmov(t,&base[pos][1],equal(babs,2));
-  cmov(t,&base[pos][2],equal(babs,3));
-  cmov(t,&base[pos][3],equal(babs,4));
-  cmov(t,&base[pos][4],equal(babs,5));
-  cmov(t,&base[pos][5],equal(babs,6));
-  cmov(t,&base[pos][6],equal(babs,7));
-  cmov(t,&base[pos][7],equal(babs,8));
+  cmov(t,&ge_base[pos][0],equal(babs,1));
+  cmov(t,&ge_base[pos][1],equal(babs,2));
+  cmov(t,&ge_base[pos][2],equal(babs,3));
+  cmov(t,&ge_base[pos][3],equal(babs,4));
+  cmov(t,&ge_base[pos][4],equal(babs,5));
+  cmov(t,&ge_base[pos][5],equal(babs,6));
+  cmov(t,&ge_base[pos][6],equal(babs,7));
+  cmov(t,&ge_base[pos][7],equal(babs,8));
   fe_copy(minust.yplusx,t->yminusx);
   fe_copy(minust.yminusx,t->yplusx);
   fe_neg(minust.xy2d,t->xy2d);
@@ -0,0 +1,235 @@
+#include "ge.h"
+#include "cpu.h"
+#include "fe4.h"
+
+/*
+Four independent fixed-base scalar multiplications at once, one per 64-bit
+lane of the AVX2 registers (see fe4.h). This is ge_scalarmult_base with
+every field element widened to a fe4, so the code below is a line by line
+transcription of ge_madd.h and ge_p2_dbl.h.
+Falls back to four calls of ge_scalarmult_base without AVX2.
+
+With the radix 2^51 or 2^64 fields (ED25519_FE51, ED25519_FE64) this
+file keeps its own radix 2^25.5 copy of the base table and converts the
+four results at the end; the 4-lane code still beats four scalar
+multiplications in those fields.
+*/
+
+#ifdef HAVE_AVX2_X4
+typedef struct {
+  fe4 X;
+  fe4 Y;
+  fe4 Z;
+} ge4_p2;
+
+typedef struct {
+  fe4 X;
+  fe4 Y;
+  fe4 Z;
+  fe4 T;
+} ge4_p3;
+
+typedef struct {
+  fe4 X;
+  fe4 Y;
+  fe4 Z;
+  fe4 T;
+} ge4_p1p1;
+
+typedef struct {
+  fe4 yplusx;
+  fe4 yminusx;
+  fe4 xy2d;
+} ge4_precomp;
+
+static AVX2 void ge4_madd(ge4_p1p1 *r,const ge4_p3 *p,const ge4_precomp *q)
+{
+  fe4 t0;
+  fe4_add(&r->X,&p->Y,&p->X);
+  fe4_sub(&r->Y,&p->Y,&p->X);
+  fe4_mul(&r->Z,&r->X,&q->yplusx,0);
+  fe4_mul(&r->Y,&r->Y,&q->yminusx,0);
+  fe4_mul(&r->T,&q->xy2d,&p->T,0);
+  fe4_add(&t0,&p->Z,&p->Z);
+  fe4_sub(&r->X,&r->Z,&r->Y);
+  fe4_add(&r->Y,&r->Z,&r->Y);
+  fe4_add(&r->Z,&t0,&r->T);
+  fe4_sub(&r->T,&t0,&r->T);
+}
+
+static AVX2 void ge4_p2_dbl(ge4_p1p1 *r,const ge4_p2 *p)
+{
+  fe4 t0;
+  fe4_mul(&r->X,&p->X,&p->X,0);
+  fe4_mul(&r->Z,&p->Y,&p->Y,0);
+  fe4_mul(&r->T,&p->Z,&p->Z,1);
+  fe4_add(&r->Y,&p->X,&p->Y);
+  fe4_mul(&t0,&r->Y,&r->Y,0);
+  fe4_add(&r->Y,&r->Z,&r->X);
+  fe4_sub(&r->Z,&r->Z,&r->X);
+  fe4_sub(&r->X,&t0,&r->Y);
+  fe4_sub(&r->T,&r->T,&r->Z);
+}
+
+static AVX2 void ge4_p1p1_to_p2(ge4_p2 *r,const ge4_p1p1 *p)
+{
+  fe4_mul(&r->X,&p->X,&p->T,0);
+  fe4_mul(&r->Y,&p->Y,&p->Z,0);
+  fe4_mul(&r->Z,&p->Z,&p->T,0);
+}
+
+static AVX2 void ge4_p1p1_to_p3(ge4_p3 *r,const ge4_p1p1 *p)
+{
+  fe4_mul(&r->X,&p->X,&p->T,0);
+  fe4_mul(&r->Y,&p->Y,&p->Z,0);
+  fe4_mul(&r->Z,&p->Z,&p->T,0);
+  fe4_mul(&r->T,&p->X,&p->Y,0);
+}
+
+static AVX2 void ge4_p3_dbl(ge4_p1p1 *r,const ge4_p3 *p)
+{
+  ge4_p2 q;
+  q.X = p->X;
+  q.Y = p->Y;
+  q.Z = p->Z;
+  ge4_p2_dbl(r,&q);
+}
+
+#if defined(ED25519_FE51) || defined(ED25519_FE64)
+typedef struct {
+  crypto_int32 yplusx[10];
+  crypto_int32 yminusx[10];
+  crypto_int32 xy2d[10];
+} precomp10;
+
+static const precomp10 base10[32][8] = {
+#include "base.h"
+} ;
+#define BASE10 base10
+#else
+#define BASE10 ge_base
+#endif
+
+static AVX2 void fe4_broadcast(fe4 *h,const crypto_int32 *f)
+{
+  int i;
+  for (i = 0;i < 10;++i) h->v[i] = _mm256_set1_epi64x(f[i]);
+}
+
+/*
+Constant time t = b * ge_base[pos][.] in every lane, b in [-8,8].
+b holds one digit per lane.
+*/
+
+static AVX2 void select4(ge4_precomp *t,int pos,__m256i b)
+{
+  ge4_precomp u;
+  ge4_precomp minust;
+  __m256i bnegative = _mm256_cmpgt_epi64(_mm256_setzero_si256(),b);
+  __m256i babs = _mm256_sub_epi64(_mm256_xor_si256(b,bnegative),bnegative);
+  __m256i mask;
+  int j;
+
+  fe4_1(&t->yplusx);
+  fe4_1(&t->yminusx);
+  fe4_0(&t->xy2d);
+  for (j = 0;j < 8;++j) {
+    mask = _mm256_cmpeq_epi64(babs,_mm256_set1_epi64x(j + 1));
+    fe4_broadcast(&u.yplusx,BASE10[pos][j].yplusx);
+    fe4_broadcast(&u.yminusx,BASE10[pos][j].yminusx);
+    fe4_broadcast(&u.xy2d,BASE10[pos][j].xy2d);
+    fe4_cmov(&t->yplusx,&u.yplusx,mask);
+    fe4_cmov(&t->yminusx,&u.yminusx,mask);
+    fe4_cmov(&t->xy2d,&u.xy2d,mask);
+  }
+  minust.yplusx = t->yminusx;
+  minust.yminusx = t->yplusx;
+  fe4_neg(&minust.xy2d,&t->xy2d);
+  fe4_cmov(&t->yplusx,&minust.yplusx,bnegative);
+  fe4_cmov(&t->yminusx,&minust.yminusx,bnegative);
+  fe4_cmov(&t->xy2d,&minust.xy2d,bnegative);
+}
+
+static AVX2 void scalarmult_base_avx2(ge_p3 *h,const signed char e[4][64])
+{
+  ge4_p1p1 r;
+  ge4_p2 s;
+  ge4_p3 h4;
+  ge4_precomp t;
+  fe X[4], Y[4], Z[4], T[4];
+  int i;
+  int j;
+
+  fe4_0(&h4.X);
+  fe4_1(&h4.Y);
+  fe4_1(&h4.Z);
+  fe4_0(&h4.T);
+
+  for (i = 1;i < 64;i += 2) {
+    select4(&t,i / 2,_mm256_set_epi64x(e[3][i],e[2][i],e[1][i],e[0][i]));
+    ge4_madd(&r,&h4,&t); ge4_p1p1_to_p3(&h4,&r);
+  }
+
+  ge4_p3_dbl(&r,&h4);  ge4_p1p1_to_p2(&s,&r);
+  ge4_p2_dbl(&r,&s); ge4_p1p1_to_p2(&s,&r);
+  ge4_p2_dbl(&r,&s); ge4_p1p1_to_p2(&s,&r);
+  ge4_p2_dbl(&r,&s); ge4_p1p1_to_p3(&h4,&r);
+
+  for (i = 0;i < 64;i += 2) {
+    select4(&t,i / 2,_mm256_set_epi64x(e[3][i],e[2][i],e[1][i],e[0][i]));
+    ge4_madd(&r,&h4,&t); ge4_p1p1_to_p3(&h4,&r);
+  }
+
+  fe4_extract(X,&h4.X);
+  fe4_extract(Y,&h4.Y);
+  fe4_extract(Z,&h4.Z);
+  fe4_extract(T,&h4.T);
+  for (j = 0;j < 4;++j) {
+    fe_copy(h[j].X,X[j]);
+    fe_copy(h[j].Y,Y[j]);
+    fe_copy(h[j].Z,Z[j]);
+    fe_copy(h[j].T,T[j]);
+  }
+}
+#endif
+
+/*
+h[j] = a[j] * B for j = 0..3
+where a[j] is 32 bytes at a + 32 * j.
+
+Preconditions:
+  a[j][31] <= 127
+*/
+
+void ge_scalarmult_base_x4(ge_p3 *h,const unsigned char *a)
+{
+#ifdef HAVE_AVX2_X4
+  signed char e[4][64];
+  signed char carry;
+  int i;
+  int j;
+
+  if (ed25519_cpu_features() & ED25519_CPU_AVX2) {
+    for (j = 0;j < 4;++j) {
+      for (i = 0;i < 32;++i) {
+        e[j][2 * i + 0] = (a[32 * j + i] >> 0) & 15;
+        e[j][2 * i + 1] = (a[32 * j + i] >> 4) & 15;
+      }
+      carry = 0;
+      for (i = 0;i < 63;++i) {
+        e[j][i] += carry;
+        carry = e[j][i] + 8;
+        carry >>= 4;
+        e[j][i] -= carry << 4;
+      }
+      e[j][63] += carry;
+    }
+    scalarmult_base_avx2(h,(const signed char (*)[64]) e);
+    return;
+  }
+#endif
+  ge_scalarmult_base(&h[0],a);
+  ge_scalarmult_base(&h[1],a + 32);
+  ge_scalarmult_base(&h[2],a + 64);
+  ge_scalarmult_base(&h[3],a + 96);
+}
@@ -1,3 +1,4 @@
+#include "backend.h"
 #include "ed25519.h"
 #include "../sha512.h"
 #include "ge.h"
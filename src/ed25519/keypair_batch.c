@@ -0,0 +1,51 @@
+#include <string.h>
+#include "backend.h"
+#include "ed25519.h"
+#include "../sha512.h"
+#include "ge.h"
+
+/*
+Derives count keypairs, like crypto_sign_keypair on each. sk holds count
+64 byte private keys whose first 32 bytes are the seeds; pk receives the
+32 byte public keys and each public key is also copied into its private
+key. The points are computed four at a time by ge_scalarmult_base_x4 and
+encoded 64 at a time by ge_p3_batch_tobytes, so a batch does one field
+inversion per 64 keys instead of one per key.
+*/
+
+int crypto_sign_keypair_batch(unsigned char *pk, unsigned char *sk, size_t count)
+{
+  unsigned char h[64];
+  unsigned char scalars[4 * 32];
+  ge_p3 A[64];
+  size_t i;
+  size_t j;
+  size_t k;
+  size_t n;
+
+  for (i = 0;i < count;i += 64) {
+    n = count - i < 64 ? count - i : 64;
+
+    for (j = 0;j < n;j += 4) {
+      for (k = 0;k < 4 && j + k < n;++k) {
+        sha512(sk + 64 * (i + j + k),32,h);
+        h[0] &= 248;
+        h[31] &= 63;
+        h[31] |= 64;
+        memcpy(scalars + 32 * k,h,32);
+      }
+      if (k == 4) {
+        ge_scalarmult_base_x4(&A[j],scalars);
+      } else {
+        while (k-- > 0) ge_scalarmult_base(&A[j + k],scalars + 32 * k);
+      }
+    }
+
+    ge_p3_batch_tobytes(pk + 32 * i,A,(int)n);
+    for (j = 0;j < n;++j) memcpy(sk + 64 * (i + j) + 32,pk + 32 * (i + j),32);
+  }
+
+  memset(h,0,sizeof h);
+  memset(scalars,0,sizeof scalars);
+  return 0;
+}
@@ -1,3 +1,5 @@
+#include <string.h>
+#include "backend.h"
 #include "ed25519.h"
 #include "../sha512.h"
 #include "crypto_verify_32.h"
@@ -12,6 +14,7 @@ int crypto_sign_open(
 {
   unsigned char h[64];
   unsigned char checkr[32];
+  sha512_context hash;
   ge_p3 A;
   ge_p2 R;
   unsigned long long i;
@@ -21,9 +24,11 @@ int crypto_sign_open(
   if (sm[63] & 224) return -2;
   if (ge_frombytes_negate_vartime(&A,pk) != 0) return -3;
 
-  for (i = 0;i < smlen;++i) m[i] = sm[i];
-  for (i = 0;i < 32;++i) m[32 + i] = pk[i];
-  sha512(m, smlen, h);
+  sha512_init(&hash);
+  sha512_update(&hash,sm,32);
+  sha512_update(&hash,pk,32);
+  sha512_update(&hash,sm + 64,smlen - 64);
+  sha512_final(&hash,h);
   sc_reduce(h);
 
   ge_double_scalarmult_vartime(&R,h,&A,sm + 32);
@@ -33,7 +38,7 @@ int crypto_sign_open(
     return crypto_verify_32(checkr,sm);
   }
 
-  for (i = 0;i < smlen - 64;++i) m[i] = sm[64 + i];
+  memmove(m,sm + 64,smlen - 64);
   for (i = smlen - 64;i < smlen;++i) m[i] = 0;
   *mlen = smlen - 64;
   return 0;
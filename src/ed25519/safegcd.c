@@ -0,0 +1,254 @@
+#include "safegcd.h"
+#include "crypto_int64.h"
+#include "crypto_uint64.h"
+#include "crypto_int128.h"
+
+/*
+Numbers are kept in five signed limbs of 62 bits, so that the 2x2
+transition matrices of 59 divsteps, scaled by 2^62, fit in 64-bit words
+and their products with limbs in 128 bits. Ten rounds of 59 divsteps are
+590, enough for any input below 2^256 (Bernstein and Yang, "Fast
+constant-time gcd computation and modular inversion", section 11; the
+layout is that of libsecp256k1's modinv64).
+
+Everything below runs the same instructions for every input.
+*/
+
+typedef struct {
+  crypto_int64 v[5];
+} signed62;
+
+typedef struct {
+  crypto_int64 u;
+  crypto_int64 v;
+  crypto_int64 q;
+  crypto_int64 r;
+} trans2x2;
+
+#define M62 ((crypto_int64) (((crypto_uint64) -1) >> 2))
+
+/* p = 2^255 - 19 = -19 + 128 * 2^248 */
+static const signed62 modulus = { { -19,0,0,0,128 } };
+
+/* 1/p mod 2^62 */
+static const crypto_uint64 modulus_inv62 = 0x39435e50d79435e5ULL;
+
+/*
+59 divsteps on the bottom 62 bits of f and g, tracking zeta = -(delta+1/2)
+where delta is that of the paper. Returns the new zeta and sets t to the
+transition matrix, scaled by 2^62.
+*/
+
+static crypto_int64 divsteps_59(crypto_int64 zeta,crypto_uint64 f0,crypto_uint64 g0,trans2x2 *t)
+{
+  crypto_uint64 u = 8;
+  crypto_uint64 v = 0;
+  crypto_uint64 q = 0;
+  crypto_uint64 r = 8;
+  crypto_uint64 f = f0;
+  crypto_uint64 g = g0;
+  /* volatile so the compiler cannot turn the masks back into branches */
+  volatile crypto_uint64 c1;
+  volatile crypto_uint64 c2;
+  crypto_uint64 mask1;
+  crypto_uint64 mask2;
+  crypto_uint64 x;
+  crypto_uint64 y;
+  crypto_uint64 z;
+  int i;
+
+  for (i = 3;i < 62;++i) {
+    /* mask1 = zeta < 0, mask2 = g odd */
+    c1 = (crypto_uint64) (zeta >> 63);
+    mask1 = c1;
+    c2 = g & 1;
+    mask2 = -c2;
+    /* g += f, or g -= f if zeta < 0, when g is odd */
+    x = (f ^ mask1) - mask1;
+    y = (u ^ mask1) - mask1;
+    z = (v ^ mask1) - mask1;
+    g += x & mask2;
+    q += y & mask2;
+    r += z & mask2;
+    /* if zeta < 0 and g was odd, swap: f += g (the old g) and zeta = -zeta */
+    mask1 &= mask2;
+    zeta = (zeta ^ (crypto_int64) mask1) - 1;
+    f += g & mask1;
+    u += q & mask1;
+    v += r & mask1;
+    g >>= 1;
+    u <<= 1;
+    v <<= 1;
+  }
+  t->u = (crypto_int64) u;
+  t->v = (crypto_int64) v;
+  t->q = (crypto_int64) q;
+  t->r = (crypto_int64) r;
+  return zeta;
+}
+
+/*
+[d,e] = t [d,e] / 2^62 mod p, adding the multiple of p that makes the
+division exact.
+
+Preconditions:
+   -2p < d,e < p
+Postconditions:
+   -2p < d,e < p
+*/
+
+static void update_de(signed62 *d,signed62 *e,const trans2x2 *t)
+{
+  const crypto_int64 u = t->u;
+  const crypto_int64 v = t->v;
+  const crypto_int64 q = t->q;
+  const crypto_int64 r = t->r;
+  crypto_int64 sd = d->v[4] >> 63;
+  crypto_int64 se = e->v[4] >> 63;
+  crypto_int64 md = (u & sd) + (v & se);
+  crypto_int64 me = (q & sd) + (r & se);
+  crypto_int128 cd;
+  crypto_int128 ce;
+  int i;
+
+  cd = (crypto_int128) u * d->v[0] + (crypto_int128) v * e->v[0];
+  ce = (crypto_int128) q * d->v[0] + (crypto_int128) r * e->v[0];
+  md -= (crypto_int64) ((modulus_inv62 * (crypto_uint64) cd + (crypto_uint64) md) & M62);
+  me -= (crypto_int64) ((modulus_inv62 * (crypto_uint64) ce + (crypto_uint64) me) & M62);
+  cd += (crypto_int128) modulus.v[0] * md;
+  ce += (crypto_int128) modulus.v[0] * me;
+  cd >>= 62;
+  ce >>= 62;
+
+  for (i = 1;i < 5;++i) {
+    cd += (crypto_int128) u * d->v[i] + (crypto_int128) v * e->v[i];
+    ce += (crypto_int128) q * d->v[i] + (crypto_int128) r * e->v[i];
+    cd += (crypto_int128) modulus.v[i] * md;
+    ce += (crypto_int128) modulus.v[i] * me;
+    d->v[i - 1] = (crypto_int64) cd & M62;
+    e->v[i - 1] = (crypto_int64) ce & M62;
+    cd >>= 62;
+    ce >>= 62;
+  }
+  d->v[4] = (crypto_int64) cd;
+  e->v[4] = (crypto_int64) ce;
+}
+
+/* [f,g] = t [f,g] / 2^62, which is exact */
+
+static void update_fg(signed62 *f,signed62 *g,const trans2x2 *t)
+{
+  const crypto_int64 u = t->u;
+  const crypto_int64 v = t->v;
+  const crypto_int64 q = t->q;
+  const crypto_int64 r = t->r;
+  crypto_int128 cf;
+  crypto_int128 cg;
+  int i;
+
+  cf = (crypto_int128) u * f->v[0] + (crypto_int128) v * g->v[0];
+  cg = (crypto_int128) q * f->v[0] + (crypto_int128) r * g->v[0];
+  cf >>= 62;
+  cg >>= 62;
+
+  for (i = 1;i < 5;++i) {
+    cf += (crypto_int128) u * f->v[i] + (crypto_int128) v * g->v[i];
+    cg += (crypto_int128) q * f->v[i] + (crypto_int128) r * g->v[i];
+    f->v[i - 1] = (crypto_int64) cf & M62;
+    g->v[i - 1] = (crypto_int64) cg & M62;
+    cf >>= 62;
+    cg >>= 62;
+  }
+  f->v[4] = (crypto_int64) cf;
+  g->v[4] = (crypto_int64) cg;
+}
+
+/*
+r = r mod p, negated first if sign < 0.
+
+Preconditions:
+   -2p < r < p
+Postconditions:
+   0 <= r < p, limbs in [0,2^62)
+*/
+
+static void normalize(signed62 *r,crypto_int64 sign)
+{
+  volatile crypto_int64 cond_add;
+  volatile crypto_int64 cond_negate;
+  crypto_int64 a;
+  crypto_int64 n;
+  int i;
+
+  a = cond_add = r->v[4] >> 63;
+  for (i = 0;i < 5;++i) r->v[i] += modulus.v[i] & a;
+  n = cond_negate = sign >> 63;
+  for (i = 0;i < 5;++i) r->v[i] = (r->v[i] ^ n) - n;
+  for (i = 0;i < 4;++i) {
+    r->v[i + 1] += r->v[i] >> 62;
+    r->v[i] &= M62;
+  }
+
+  a = cond_add = r->v[4] >> 63;
+  for (i = 0;i < 5;++i) r->v[i] += modulus.v[i] & a;
+  for (i = 0;i < 4;++i) {
+    r->v[i + 1] += r->v[i] >> 62;
+    r->v[i] &= M62;
+  }
+}
+
+static crypto_uint64 load_8(const unsigned char *in)
+{
+  crypto_uint64 result = 0;
+  int i;
+  for (i = 7;i >= 0;--i) result = (result << 8) | in[i];
+  return result;
+}
+
+static void store_8(unsigned char *out,crypto_uint64 x)
+{
+  int i;
+  for (i = 0;i < 8;++i) { out[i] = (unsigned char) x; x >>= 8; }
+}
+
+/*
+out = 1/in mod p, and 0 for in = 0, as fe_invert computes.
+
+Preconditions:
+   in < p, a canonical encoding as fe_tobytes gives; in = p would give 1
+*/
+
+void safegcd_invert(unsigned char *out,const unsigned char *in)
+{
+  crypto_uint64 w0 = load_8(in);
+  crypto_uint64 w1 = load_8(in + 8);
+  crypto_uint64 w2 = load_8(in + 16);
+  crypto_uint64 w3 = load_8(in + 24);
+  signed62 d = { { 0,0,0,0,0 } };
+  signed62 e = { { 1,0,0,0,0 } };
+  signed62 f = modulus;
+  signed62 g;
+  trans2x2 t;
+  crypto_int64 zeta = -1;
+  int i;
+
+  g.v[0] = (crypto_int64) (w0 & M62);
+  g.v[1] = (crypto_int64) (((w0 >> 62) | (w1 << 2)) & M62);
+  g.v[2] = (crypto_int64) (((w1 >> 60) | (w2 << 4)) & M62);
+  g.v[3] = (crypto_int64) (((w2 >> 58) | (w3 << 6)) & M62);
+  g.v[4] = (crypto_int64) (w3 >> 56);
+
+  for (i = 0;i < 10;++i) {
+    zeta = divsteps_59(zeta,(crypto_uint64) f.v[0],(crypto_uint64) g.v[0],&t);
+    update_de(&d,&e,&t);
+    update_fg(&f,&g,&t);
+  }
+
+  /* f = +-1 now, or +-p for in = 0, and d = +-1/in */
+  normalize(&d,f.v[4]);
+
+  store_8(out,(crypto_uint64) d.v[0] | ((crypto_uint64) d.v[1] << 62));
+  store_8(out + 8,((crypto_uint64) d.v[1] >> 2) | ((crypto_uint64) d.v[2] << 60));
+  store_8(out + 16,((crypto_uint64) d.v[2] >> 4) | ((crypto_uint64) d.v[3] << 58));
+  store_8(out + 24,((crypto_uint64) d.v[3] >> 6) | ((crypto_uint64) d.v[4] << 56));
+}
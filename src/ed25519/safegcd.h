@@ -0,0 +1,14 @@
+#ifndef SAFEGCD_H
+#define SAFEGCD_H
+
+/*
+Inversion modulo p = 2^255 - 19 by the constant-time divstep algorithm of
+Bernstein and Yang, on 32-byte little-endian encodings. Shared by every
+field backend; see fe_invert.c.
+*/
+
+#define safegcd_invert crypto_sign_ed25519_ref10_safegcd_invert
+
+extern void safegcd_invert(unsigned char *,const unsigned char *);
+
+#endif
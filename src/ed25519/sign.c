@@ -1,41 +1,82 @@
+#include <string.h>
+#include "backend.h"
 #include "ed25519.h"
 #include "../sha512.h"
 #include "ge.h"
 #include "sc.h"
 
-int crypto_sign(
-  unsigned char *sm,unsigned long long *smlen,
-  const unsigned char *m,unsigned long long mlen,
-  const unsigned char *sk
-)
-{
-  unsigned char az[64];
-  unsigned char r[64];
-  unsigned char hram[64];
-  ge_p3 R;
-  unsigned long long i;
+/*
+Expands the 32 byte seed at the start of sk into az: the clamped secret
+scalar followed by the 32 byte nonce prefix.
+*/
 
+void crypto_sign_expand(unsigned char *az, const unsigned char *sk)
+{
   sha512(sk, 32, az);
-  // crypto_hash_sha512(az,sk,32);
   az[0] &= 248;
   az[31] &= 63;
   az[31] |= 64;
+}
 
-  *smlen = mlen + 64;
-  for (i = 0;i < mlen;++i) sm[64 + i] = m[i];
-  for (i = 0;i < 32;++i) sm[32 + i] = az[32 + i];
-  sha512(sm + 32, mlen + 32, r);
-  // crypto_hash_sha512(r,sm + 32,mlen + 32);
-  for (i = 0;i < 32;++i) sm[32 + i] = sk[32 + i];
+/*
+Writes the 64 byte signature of m to sig without copying m anywhere;
+the message is hashed in place through sha512_update.
+az: the expanded key from crypto_sign_expand
+pk: the 32 byte public key
+sig may overlap m.
+*/
+
+int crypto_sign_detached_expanded(unsigned char *sig, const unsigned char *m, size_t mlen,
+                                  const unsigned char *az, const unsigned char *pk)
+{
+  unsigned char r[64];
+  unsigned char hram[64];
+  unsigned char s[64];
+  sha512_context hash;
+  ge_p3 R;
+
+  sha512_init(&hash);
+  sha512_update(&hash, az + 32, 32);
+  sha512_update(&hash, m, mlen);
+  sha512_final(&hash, r);
 
   sc_reduce(r);
   ge_scalarmult_base(&R,r);
-  ge_p3_tobytes(sm,&R);
+  ge_p3_tobytes(s,&R);
+
+  sha512_init(&hash);
+  sha512_update(&hash, s, 32);
+  sha512_update(&hash, pk, 32);
+  sha512_update(&hash, m, mlen);
+  sha512_final(&hash, hram);
 
-  sha512(sm, mlen + 64, hram);
-  // crypto_hash_sha512(hram,sm,mlen + 64);
   sc_reduce(hram);
-  sc_muladd(sm + 32,hram,az,r);
+  sc_muladd(s + 32,hram,az,r);
 
+  memcpy(sig, s, 64);
   return 0;
 }
+
+int crypto_sign_detached(unsigned char *sig, const unsigned char *m, size_t mlen, const unsigned char *sk)
+{
+  unsigned char az[64];
+
+  crypto_sign_expand(az, sk);
+  return crypto_sign_detached_expanded(sig, m, mlen, az, sk + 32);
+}
+
+/*
+sm = signature || m. m may already be at sm + 64; the message is moved
+there and signed in place, so no scratch memory grows with mlen.
+*/
+
+int crypto_sign(
+  unsigned char *sm,unsigned long long *smlen,
+  const unsigned char *m,unsigned long long mlen,
+  const unsigned char *sk
+)
+{
+  memmove(sm + 64,m,mlen);
+  *smlen = mlen + 64;
+  return crypto_sign_detached(sm,sm + 64,mlen,sk);
+}
@@ -0,0 +1,116 @@
+#include <stdlib.h>
+#include "backend.h"
+#include "ed25519.h"
+#include "../sha512.h"
+#include "ge.h"
+#include "sc.h"
+
+/*
+Ed25519 hashes the message twice: once for the nonce r = H(prefix || M)
+and once for H(R || A || M). A signer takes the message in pieces for
+each pass in turn, so the message never has to be in memory at once.
+
+If the two passes saw different messages, r would be reused with a
+different H(R || A || M), which gives away the secret key. Pass two
+therefore hashes prefix || M again, and final refuses to sign unless
+it matches the nonce from pass one.
+*/
+
+struct crypto_sign_signer {
+  unsigned char az[64];
+  unsigned char pk[32];
+  unsigned char r[64];
+  unsigned char R[32];
+  sha512_context nonce;
+  sha512_context hram;
+  int pass;
+};
+
+/*
+sk: the 64 byte secret key
+returns: a signer in pass one, or NULL if memory ran out
+*/
+
+crypto_sign_signer *crypto_sign_signer_new(const unsigned char *sk)
+{
+  crypto_sign_signer *s;
+  int i;
+
+  s = (crypto_sign_signer *) malloc(sizeof(crypto_sign_signer));
+  if (!s) return NULL;
+  crypto_sign_expand(s->az,sk);
+  for (i = 0;i < 32;++i) s->pk[i] = sk[32 + i];
+  s->pass = 1;
+
+  sha512_init(&s->nonce);
+  sha512_update(&s->nonce,s->az + 32,32);
+  return s;
+}
+
+void crypto_sign_signer_update(crypto_sign_signer *s, const unsigned char *m, size_t mlen)
+{
+  sha512_update(&s->nonce,m,mlen);
+  if (s->pass == 2) sha512_update(&s->hram,m,mlen);
+}
+
+/*
+Ends pass one: computes the nonce point R and starts pass two.
+returns: 0, or -1 if pass one was already over
+*/
+
+int crypto_sign_signer_rewind(crypto_sign_signer *s)
+{
+  ge_p3 R;
+
+  if (s->pass != 1) return -1;
+  sha512_final(&s->nonce,s->r);
+  sc_reduce(s->r);
+  ge_scalarmult_base(&R,s->r);
+  ge_p3_tobytes(s->R,&R);
+
+  sha512_init(&s->hram);
+  sha512_update(&s->hram,s->R,32);
+  sha512_update(&s->hram,s->pk,32);
+  sha512_init(&s->nonce);
+  sha512_update(&s->nonce,s->az + 32,32);
+  s->pass = 2;
+  return 0;
+}
+
+/*
+Ends pass two and writes the 64 byte signature to sig.
+returns: 0, -1 if pass two has not started or final was already called,
+         -2 if the passes saw different messages; sig is then untouched
+*/
+
+int crypto_sign_signer_final(crypto_sign_signer *s, unsigned char *sig)
+{
+  unsigned char check[64];
+  unsigned char hram[64];
+  unsigned char diff = 0;
+  int i;
+
+  if (s->pass != 2) return -1;
+  s->pass = 3;
+
+  sha512_final(&s->nonce,check);
+  sc_reduce(check);
+  for (i = 0;i < 32;++i) diff |= check[i] ^ s->r[i];
+  if (diff) return -2;
+
+  sha512_final(&s->hram,hram);
+  sc_reduce(hram);
+  for (i = 0;i < 32;++i) sig[i] = s->R[i];
+  sc_muladd(sig + 32,hram,s->az,s->r);
+  return 0;
+}
+
+void crypto_sign_signer_free(crypto_sign_signer *s)
+{
+  volatile unsigned char *p = (volatile unsigned char *) s;
+  size_t i;
+
+  if (!s) return;
+  for (i = 0;i < sizeof(crypto_sign_signer);++i) p[i] = 0;
+  free(s);
+}
@@ -0,0 +1,70 @@
+#include <stdlib.h>
+#include "backend.h"
+#include "ed25519.h"
+#include "../sha512.h"
+#include "crypto_verify_32.h"
+#include "ge.h"
+#include "sc.h"
+
+struct crypto_sign_verifier {
+  sha512_context hash;
+  unsigned char signature[64];
+  ge_p3 negA;
+  int result;
+};
+
+/*
+Starts verifying signature against pk for a message given in pieces to
+crypto_sign_verifier_update. The key is decoded here so only the hash
+and the curve check are left for crypto_sign_verifier_final.
+returns: the verifier, or NULL if memory ran out
+*/
+
+crypto_sign_verifier *crypto_sign_verifier_new(const unsigned char *signature, const unsigned char *pk)
+{
+  crypto_sign_verifier *v;
+  int i;
+
+  v = (crypto_sign_verifier *) malloc(sizeof(crypto_sign_verifier));
+  if (!v) return NULL;
+  for (i = 0;i < 64;++i) v->signature[i] = signature[i];
+  v->result = 0;
+  if (signature[63] & 224) v->result = -1;
+  else if (ge_frombytes_negate_vartime(&v->negA,pk) != 0) v->result = -2;
+
+  sha512_init(&v->hash);
+  sha512_update(&v->hash,signature,32);
+  sha512_update(&v->hash,pk,32);
+  return v;
+}
+
+void crypto_sign_verifier_update(crypto_sign_verifier *v, const unsigned char *m, size_t mlen)
+{
+  if (v->result == 0) sha512_update(&v->hash,m,mlen);
+}
+
+/*
+returns: what crypto_sign_verify gives for the whole message
+*/
+
+int crypto_sign_verifier_final(crypto_sign_verifier *v)
+{
+  unsigned char h[64];
+  unsigned char checker[32];
+  ge_p2 R;
+
+  if (v->result != 0) return v->result;
+
+  sha512_final(&v->hash,h);
+  sc_reduce(h);
+  ge_double_scalarmult_vartime(&R,h,&v->negA,v->signature + 32);
+  ge_tobytes(checker,&R);
+
+  if (crypto_verify_32(checker,v->signature) != 0) return -3;
+  return 0;
+}
+
+void crypto_sign_verifier_free(crypto_sign_verifier *v)
+{
+  free(v);
+}
@@ -0,0 +1,71 @@
+#include <stdlib.h>
+#include <string.h>
+#include "backend.h"
+#include "ed25519.h"
+#include "../sha512.h"
+#include "crypto_verify_32.h"
+#include "ge.h"
+#include "sc.h"
+
+struct crypto_sign_verifying_key {
+  unsigned char pk[32];
+  ge_precomp negAi[32]; /* -A,-3A,-5A,...,-63A */
+};
+
+/*
+Decompresses pk once and precomputes the odd multiples of -A used by
+crypto_sign_verify_with_key.
+status: if not NULL, set to 0 on success, -2 if pk does not decode (the
+        code crypto_sign_verify returns for it) or -1 if memory ran out
+returns: the key, or NULL on failure
+*/
+
+crypto_sign_verifying_key *crypto_sign_verifying_key_new(const unsigned char *pk,int *status)
+{
+  crypto_sign_verifying_key *key;
+  ge_p3 negA;
+
+  if (status) *status = -2;
+  if (ge_frombytes_negate_vartime(&negA,pk) != 0) return NULL;
+  if (status) *status = -1;
+  key = (crypto_sign_verifying_key *) malloc(sizeof(crypto_sign_verifying_key));
+  if (!key) return NULL;
+  if (status) *status = 0;
+  memcpy(key->pk,pk,32);
+  ge_precomp_odd_multiples(key->negAi,&negA,32);
+  return key;
+}
+
+void crypto_sign_verifying_key_free(crypto_sign_verifying_key *key)
+{
+  free(key);
+}
+
+/*
+Same result as crypto_sign_verify with the key's public key, without
+decompressing the key or building its table.
+*/
+
+int crypto_sign_verify_with_key(const unsigned char *signature, const unsigned char *message, size_t message_len,
+                                const crypto_sign_verifying_key *key)
+{
+  unsigned char h[64];
+  unsigned char checker[32];
+  sha512_context hash;
+  ge_p2 R;
+
+  if (signature[63] & 224) return -1;
+
+  sha512_init(&hash);
+  sha512_update(&hash,signature,32);
+  sha512_update(&hash,key->pk,32);
+  sha512_update(&hash,message,message_len);
+  sha512_final(&hash,h);
+
+  sc_reduce(h);
+  ge_double_scalarmult_precomp_vartime(&R,h,key->negAi,signature + 32);
+  ge_tobytes(checker,&R);
+
+  if (crypto_verify_32(checker,signature) != 0) return -3;
+  return 0;
+}
@@ -0,0 +1,227 @@
+#include "pool.h"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+PoolScratch::~PoolScratch() {
+	free(data);
+}
+
+void *PoolScratch::Get(size_t bytes) {
+	if (bytes > size) {
+		size_t grown = size * 2 > bytes ? size * 2 : bytes;
+		free(data);
+		data = malloc(grown);
+		size = data == NULL ? 0 : grown;
+	}
+	return data;
+}
+
+namespace {
+
+struct JobState {
+	PoolJob *job;
+	std::atomic<size_t> remaining;
+	uv_async_t async;
+};
+
+struct Task {
+	JobState *state;
+	size_t chunk;
+};
+
+struct Worker {
+	std::mutex mutex;
+	std::deque<Task> tasks;
+	PoolScratch scratch;
+};
+
+/**
+ * Fixed set of threads, each with its own deque of chunks. A thread runs
+ * its newest chunk first and, when its deque is empty, steals the oldest
+ * chunk of another thread, so one big job spreads over every thread.
+ **/
+class Pool {
+public:
+	Pool(unsigned int count, bool pin) : queued(0), next(0) {
+		for (unsigned int i = 0; i < count; i++) {
+			workers.push_back(new Worker());
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			std::thread(&Pool::Run, this, i, pin).detach();
+		}
+	}
+
+	void Submit(uv_loop_t *loop, PoolJob *job) {
+		JobState *state = new JobState();
+		size_t chunks = job->Chunks();
+		state->job = job;
+		state->remaining = chunks;
+		state->async.data = state;
+		uv_async_init(loop, &state->async, OnComplete);
+		if (chunks == 0) {
+			uv_async_send(&state->async);
+			return;
+		}
+
+		// Count the chunks before any of them can be taken, so a thread
+		// that is already awake cannot take one first and wrap queued.
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			queued += chunks;
+		}
+		size_t start = next.fetch_add(1);
+		for (size_t i = 0; i < chunks; i++) {
+			Worker *worker = workers[(start + i) % workers.size()];
+			std::lock_guard<std::mutex> lock(worker->mutex);
+			worker->tasks.push_back(Task{state, i});
+		}
+		wake.notify_all();
+	}
+
+	unsigned int Threads() const {
+		return (unsigned int)workers.size();
+	}
+
+private:
+	static void OnComplete(uv_async_t *handle) {
+		JobState *state = (JobState*)handle->data;
+		state->job->Complete();
+		uv_close((uv_handle_t*)&state->async, OnClose);
+	}
+
+	static void OnClose(uv_handle_t *handle) {
+		delete (JobState*)handle->data;
+	}
+
+	static void Pin(unsigned int index) {
+		unsigned int cpus = std::thread::hardware_concurrency();
+		if (cpus == 0) {
+			return;
+		}
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(index % cpus, &set);
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(_WIN32)
+		SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (index % cpus % (sizeof(DWORD_PTR) * 8)));
+#endif
+	}
+
+	bool Take(size_t self, Task *task) {
+		size_t count = workers.size();
+		for (size_t i = 0; i < count; i++) {
+			Worker *worker = workers[(self + i) % count];
+			std::lock_guard<std::mutex> lock(worker->mutex);
+			if (worker->tasks.empty()) {
+				continue;
+			}
+			if (i == 0) {
+				*task = worker->tasks.back();
+				worker->tasks.pop_back();
+			} else {
+				*task = worker->tasks.front();
+				worker->tasks.pop_front();
+			}
+			queued--;
+			return true;
+		}
+		return false;
+	}
+
+	void Run(unsigned int self, bool pin) {
+		Worker *worker = workers[self];
+		if (pin) {
+			Pin(self);
+		}
+		for (;;) {
+			Task task;
+			if (!Take(self, &task)) {
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				wake.wait(lock, [this] { return queued > 0; });
+				continue;
+			}
+			task.state->job->RunChunk(task.chunk, &worker->scratch);
+			if (task.state->remaining.fetch_sub(1) == 1) {
+				uv_async_send(&task.state->async);
+			}
+		}
+	}
+
+	std::vector<Worker*> workers;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::atomic<size_t> queued;
+	std::atomic<size_t> next;
+};
+
+std::mutex poolMutex;
+Pool *pool = NULL;
+bool configured = false;
+unsigned int configuredThreads = 0;
+bool configuredPin = false;
+
+/**
+ * Starts the pool on first use. Unless PoolConfigure ran first, the thread
+ * count and pinning come from ED25519_POOL_THREADS and ED25519_POOL_PIN.
+ * The pool lives until the process exits.
+ **/
+Pool *GetPool() {
+	std::lock_guard<std::mutex> lock(poolMutex);
+	if (pool != NULL) {
+		return pool;
+	}
+	if (!configured) {
+		const char *threads = getenv("ED25519_POOL_THREADS");
+		const char *pin = getenv("ED25519_POOL_PIN");
+		configuredThreads = threads != NULL ? (unsigned int)strtoul(threads, NULL, 10) : 0;
+		configuredPin = pin != NULL && pin[0] != '\0' && pin[0] != '0';
+	}
+	unsigned int count = configuredThreads;
+	if (count == 0) {
+		count = std::thread::hardware_concurrency();
+	}
+	if (count == 0) {
+		count = 1;
+	}
+	if (count > 256) {
+		count = 256;
+	}
+	pool = new Pool(count, configuredPin);
+	return pool;
+}
+
+}
+
+bool PoolConfigure(unsigned int threads, bool pin) {
+	std::lock_guard<std::mutex> lock(poolMutex);
+	if (pool != NULL) {
+		return false;
+	}
+	configured = true;
+	configuredThreads = threads;
+	configuredPin = pin;
+	return true;
+}
+
+void PoolSubmit(uv_loop_t *loop, PoolJob *job) {
+	GetPool()->Submit(loop, job);
+}
+
+unsigned int PoolThreads() {
+	return GetPool()->Threads();
+}
@@ -0,0 +1,58 @@
+#ifndef ED25519_POOL_H
+#define ED25519_POOL_H
+
+#include <uv.h>
+
+#include <stddef.h>
+
+/**
+ * Reusable per-thread scratch memory. Get returns at least the requested
+ * number of bytes, 16 byte aligned; the block only grows, so once a thread
+ * has seen its largest chunk the hot path does no allocation.
+ **/
+class PoolScratch {
+public:
+	PoolScratch() : data(NULL), size(0) {}
+	~PoolScratch();
+
+	void *Get(size_t bytes);
+
+private:
+	void *data;
+	size_t size;
+};
+
+/**
+ * A unit of work for the pool, split into Chunks() independent chunks.
+ * RunChunk is called once per chunk on the pool threads, in any order and
+ * possibly at the same time. Complete is called on the submitting event
+ * loop's thread after every chunk has run.
+ **/
+class PoolJob {
+public:
+	virtual ~PoolJob() {}
+	virtual size_t Chunks() = 0;
+	virtual void RunChunk(size_t chunk, PoolScratch *scratch) = 0;
+	virtual void Complete() = 0;
+};
+
+/**
+ * Configures the pool before its threads start.
+ * threads: number of worker threads, 0 for one per CPU
+ * pin: bind worker i to CPU i (Linux and Windows only)
+ * returns: false if the pool is already running
+ **/
+bool PoolConfigure(unsigned int threads, bool pin);
+
+/**
+ * Queues every chunk of job, starting the pool on first use. Must be
+ * called on the thread running loop.
+ **/
+void PoolSubmit(uv_loop_t *loop, PoolJob *job);
+
+/**
+ * returns: the number of worker threads, starting the pool if needed
+ **/
+unsigned int PoolThreads();
+
+#endif
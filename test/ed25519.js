@@ -1,4 +1,9 @@
+var childProcess = require("child_process");
 var crypto = require("crypto");
+var fs = require("fs");
+var os = require("os");
+var path = require("path");
+var stream = require("stream");
 var assert = require("assert");
 var ed25519 = require("../");
 var data = {
@@ -11,6 +16,18 @@ var data = {
 };
 
 describe("ed25519", function () {
+  function makeBatch(count) {
+    var batch = { messages: [], signatures: [], publicKeys: [] };
+    for (var i = 0; i < count; i++) {
+      var keyPair = ed25519.MakeKeypair(crypto.randomBytes(32));
+      var message = crypto.randomBytes(i % 7 * 10);
+      batch.messages.push(message);
+      batch.signatures.push(ed25519.Sign(message, keyPair));
+      batch.publicKeys.push(keyPair.publicKey);
+    }
+    return batch;
+  }
+
   describe("#MakeKeypair()", function () {
     it("returns a public and private key", function () {
       var seed = Buffer.from(data.seed, "hex");
@@ -51,6 +68,15 @@ describe("ed25519", function () {
 
       assert.equal(signature.toString("hex"), data.signature);
     });
+
+    it("Signs large messages", function () {
+      var privateKey = Buffer.from(data.privateKey, "hex");
+      var message = crypto.randomBytes(16 * 1024 * 1024);
+      var signature = ed25519.Sign(message, privateKey);
+
+      assert.equal(signature.toString("hex"), ed25519.SignBatch([message], privateKey).toString("hex"));
+      assert.ok(ed25519.Verify(message, signature, privateKey.slice(32)));
+    });
   });
 
   describe("#Verify", function() {
@@ -70,4 +96,918 @@ describe("ed25519", function () {
       assert.ok(!ed25519.Verify(message, signature, publicKey));
     });
   })
+
+  describe("#MakeKeypairAsync()", function () {
+    it("returns a public and private key to a callback", function (done) {
+      var seed = Buffer.from(data.seed, "hex");
+      ed25519.MakeKeypairAsync(seed, function (err, keyPair) {
+        assert.ifError(err);
+        assert.equal(keyPair.publicKey.toString("hex"), data.publicKey);
+        assert.equal(keyPair.privateKey.toString("hex"), data.privateKey);
+        done();
+      });
+    });
+
+    it("returns a Promise without a callback", function () {
+      var seed = Buffer.from(data.seed, "hex");
+      return ed25519.MakeKeypairAsync(seed).then(function (keyPair) {
+        assert.equal(keyPair.publicKey.toString("hex"), data.publicKey);
+        assert.equal(keyPair.privateKey.toString("hex"), data.privateKey);
+      });
+    });
+  });
+
+  describe("#SignAsync()", function () {
+    it("Generates a valid signature using a seed", function () {
+      var seed = Buffer.from(data.seed, "hex");
+      var message = Buffer.from(data.message);
+      return ed25519.SignAsync(message, seed).then(function (signature) {
+        assert.equal(signature.toString("hex"), data.signature);
+      });
+    });
+
+    it("Generates a valid signature using a keyPair", function (done) {
+      var privateKey = Buffer.from(data.privateKey, "hex");
+      var publicKey = Buffer.from(data.publicKey, "hex");
+      var message = Buffer.from(data.message);
+      ed25519.SignAsync(message, { privateKey: privateKey, publicKey: publicKey }, function (err, signature) {
+        assert.ifError(err);
+        assert.equal(signature.toString("hex"), data.signature);
+        done();
+      });
+    });
+
+    it("rejects an invalid key", function () {
+      var message = Buffer.from(data.message);
+      return ed25519.SignAsync(message, Buffer.alloc(16)).then(function () {
+        assert.fail("expected a rejection");
+      }, function (err) {
+        assert.ok(err instanceof Error);
+      });
+    });
+  });
+
+  describe("#VerifyAsync()", function () {
+    it("resolves true if the signature is valid", function () {
+      var publicKey = Buffer.from(data.publicKey, "hex");
+      var signature = Buffer.from(data.signature, "hex");
+      var message = Buffer.from(data.message);
+      return ed25519.VerifyAsync(message, signature, publicKey).then(function (valid) {
+        assert.strictEqual(valid, true);
+      });
+    });
+
+    it("passes false to the callback if the signature is not valid", function (done) {
+      var publicKey = Buffer.from(data.publicKey, "hex");
+      var signature = Buffer.from(data.invalidSignature, "hex");
+      var message = Buffer.from(data.message);
+      ed25519.VerifyAsync(message, signature, publicKey, function (err, valid) {
+        assert.ifError(err);
+        assert.strictEqual(valid, false);
+        done();
+      });
+    });
+  });
+
+  describe("#SetVerifyBatching()", function () {
+    afterEach(function () {
+      ed25519.SetVerifyBatching(false);
+    });
+
+    it("gives each batched VerifyAsync call its own result", function () {
+      var batch = makeBatch(40);
+      batch.signatures[3] = Buffer.from(data.invalidSignature, "hex");
+      batch.messages[17] = Buffer.from("tampered");
+      ed25519.SetVerifyBatching({ window: 2000, maxBatch: 16 });
+      return Promise.all(batch.messages.map(function (message, i) {
+        return ed25519.VerifyAsync(message, batch.signatures[i], batch.publicKeys[i]);
+      })).then(function (results) {
+        results.forEach(function (valid, i) {
+          assert.strictEqual(valid, i !== 3 && i !== 17);
+        });
+      });
+    });
+
+    it("still throws for bad arguments", function () {
+      ed25519.SetVerifyBatching({});
+      assert.throws(function () {
+        ed25519.VerifyAsync(Buffer.from(data.message), Buffer.alloc(10), Buffer.alloc(32), function () {});
+      });
+      assert.throws(function () {
+        ed25519.SetVerifyBatching({ maxBatch: 0 });
+      });
+    });
+  });
+
+  describe("#VerifyAt() and #SignAt()", function () {
+    function makeFrame() {
+      var message = Buffer.from(data.message);
+      var frame = new Uint8Array(new SharedArrayBuffer(8 + 32 + 64 + message.length));
+      frame.set(Buffer.from(data.publicKey, "hex"), 8);
+      frame.set(message, 8 + 32 + 64);
+      return frame;
+    }
+
+    it("signs and verifies slices of a shared buffer in place", function () {
+      var frame = makeFrame();
+      ed25519.SignAt(frame, 104, 4, 40, Buffer.from(data.privateKey, "hex"));
+      assert.equal(Buffer.from(frame.buffer, 40, 64).toString("hex"), data.signature);
+      assert.strictEqual(ed25519.VerifyAt(frame, 104, 4, 40, 8), true);
+      assert.strictEqual(ed25519.VerifyAt(frame.buffer, 104, 4, 40, 8), true);
+      assert.strictEqual(ed25519.VerifyAt(new DataView(frame.buffer, 8), 96, 4, 32, 0), true);
+      frame[105] ^= 1;
+      assert.strictEqual(ed25519.VerifyAt(frame, 104, 4, 40, 8), false);
+    });
+
+    it("may sign over the message", function () {
+      var out = new ArrayBuffer(64);
+      new Uint8Array(out).set(Buffer.from(data.message));
+      ed25519.SignAt(out, 0, 4, 0, Buffer.from(data.seed, "hex"));
+      assert.equal(Buffer.from(out).toString("hex"), data.signature);
+    });
+
+    it("rejects ranges outside the buffer", function () {
+      var frame = makeFrame();
+      assert.throws(function () {
+        ed25519.VerifyAt(frame, 104, 5, 40, 8);
+      }, RangeError);
+      assert.throws(function () {
+        ed25519.VerifyAt(frame, 104, 4, 50, 8);
+      }, RangeError);
+      assert.throws(function () {
+        ed25519.SignAt(frame, 0, 4, -1, Buffer.from(data.seed, "hex"));
+      });
+    });
+  });
+
+  describe("#VerifyBatch()", function () {
+    it("returns true and a full bitmap if every signature is valid", function () {
+      var batch = makeBatch(20);
+      var result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys);
+      assert.strictEqual(result.valid, true);
+      assert.equal(result.bitmap.toString("hex"), "ffff0f");
+    });
+
+    it("marks the invalid signatures in the bitmap", function () {
+      var batch = makeBatch(20);
+      batch.signatures[3] = Buffer.from(data.invalidSignature, "hex");
+      batch.messages[17] = Buffer.from("tampered");
+      var result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys);
+      assert.strictEqual(result.valid, false);
+      assert.equal(result.bitmap.toString("hex"), "f7ff0d");
+    });
+
+    it("handles small and empty batches", function () {
+      var batch = makeBatch(2);
+      batch.messages[1] = Buffer.from("tampered");
+      var result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys);
+      assert.strictEqual(result.valid, false);
+      assert.equal(result.bitmap.toString("hex"), "01");
+      result = ed25519.VerifyBatch([], [], []);
+      assert.strictEqual(result.valid, true);
+      assert.equal(result.bitmap.length, 0);
+    });
+
+    it("handles many signatures from the same keys", function () {
+      var keyPairs = [ed25519.MakeKeypair(crypto.randomBytes(32)), ed25519.MakeKeypair(crypto.randomBytes(32))];
+      var badKey = Buffer.alloc(32, 0xff);
+      var batch = { messages: [], signatures: [], publicKeys: [] };
+      for (var i = 0; i < 40; i++) {
+        var message = crypto.randomBytes(i);
+        batch.messages.push(message);
+        batch.signatures.push(ed25519.Sign(message, keyPairs[i % 2]));
+        batch.publicKeys.push(i % 10 == 9 ? badKey : keyPairs[i % 2].publicKey);
+      }
+      var result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys);
+      assert.strictEqual(result.valid, false);
+      assert.equal(result.bitmap.toString("hex"), "fffdf7df7f");
+      batch.signatures[4] = batch.signatures[6];
+      result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys);
+      assert.equal(result.bitmap.toString("hex"), "effdf7df7f");
+    });
+
+    it("rejects forgeries when more keys decode than signatures are checked", function () {
+      for (var run = 0; run < 8; run++) {
+        var batch = { messages: [], signatures: [], publicKeys: [] };
+        for (var i = 0; i < 8; i++) {
+          var keyPair = ed25519.MakeKeypair(crypto.randomBytes(32));
+          var message = crypto.randomBytes(16);
+          var signature = ed25519.Sign(message, keyPair);
+          if (i < 5) {
+            signature[63] |= 0xe0;
+          } else {
+            signature[40] ^= 1;
+          }
+          batch.messages.push(message);
+          batch.signatures.push(signature);
+          batch.publicKeys.push(keyPair.publicKey);
+        }
+        var result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys);
+        assert.strictEqual(result.valid, false);
+        assert.equal(result.bitmap.toString("hex"), "00");
+      }
+    });
+
+    it("finds a few bad signatures in a large batch", function () {
+      var keyPair = ed25519.MakeKeypair(crypto.randomBytes(32));
+      var batch = { messages: [], signatures: [], publicKeys: [] };
+      for (var i = 0; i < 300; i++) {
+        var message = crypto.randomBytes(16);
+        batch.messages.push(message);
+        batch.signatures.push(ed25519.Sign(message, keyPair));
+        batch.publicKeys.push(keyPair.publicKey);
+      }
+      [7, 150, 151, 299].forEach(function (i) {
+        batch.messages[i] = crypto.randomBytes(16);
+      });
+      var result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys);
+      var bad = [];
+      for (var i = 0; i < 300; i++) {
+        if (!(result.bitmap[i >> 3] & (1 << (i & 7)))) {
+          bad.push(i);
+        }
+      }
+      assert.deepEqual(bad, [7, 150, 151, 299]);
+    });
+
+    it("reports only the first bad signature when failing fast", function () {
+      var batch = makeBatch(40);
+      var result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys, { failFast: true });
+      assert.deepEqual(result, { valid: true, firstInvalid: -1 });
+      batch.messages[33] = Buffer.from("tampered");
+      batch.signatures[21] = Buffer.from(data.invalidSignature, "hex");
+      result = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys, { failFast: true });
+      assert.deepEqual(result, { valid: false, firstInvalid: 21 });
+    });
+
+    it("throws on mismatched arrays", function () {
+      assert.throws(function () {
+        ed25519.VerifyBatch([Buffer.alloc(1)], [], []);
+      });
+    });
+  });
+
+  describe("#VerifyRecords()", function () {
+    function makeRecords(count) {
+      var records = [];
+      for (var i = 0; i < count; i++) {
+        var keyPair = ed25519.MakeKeypair(crypto.randomBytes(32));
+        var message = crypto.randomBytes(i % 50);
+        var length = Buffer.alloc(4);
+        length.writeUInt32LE(message.length);
+        records.push(keyPair.publicKey, ed25519.Sign(message, keyPair), length, message);
+      }
+      return Buffer.concat(records);
+    }
+
+    it("verifies every record and marks the bad ones", function () {
+      var buffer = makeRecords(20);
+      assert.equal(ed25519.VerifyRecords(buffer).toString("hex"), "ffff0f");
+      buffer[32 + 1] ^= 1;
+      assert.equal(ed25519.VerifyRecords(buffer.buffer.slice(buffer.byteOffset, buffer.byteOffset + buffer.length)).toString("hex"), "feff0f");
+      assert.equal(ed25519.VerifyRecords(Buffer.alloc(0)).length, 0);
+    });
+
+    it("throws on a truncated record", function () {
+      var buffer = makeRecords(3);
+      assert.throws(function () {
+        ed25519.VerifyRecords(buffer.subarray(0, buffer.length - 1));
+      }, RangeError);
+      assert.throws(function () {
+        ed25519.VerifyRecords(buffer.subarray(0, 99));
+      }, RangeError);
+    });
+  });
+
+  describe("#SignBatch()", function () {
+    it("returns the same signatures as Sign", function () {
+      var privateKey = Buffer.from(data.privateKey, "hex");
+      var messages = [];
+      for (var i = 0; i < 11; i++) {
+        messages.push(crypto.randomBytes(i * 13));
+      }
+      var signatures = ed25519.SignBatch(messages, privateKey);
+      assert.equal(signatures.length, 64 * messages.length);
+      messages.forEach(function (message, i) {
+        assert.equal(
+          signatures.slice(64 * i, 64 * (i + 1)).toString("hex"),
+          ed25519.Sign(message, privateKey).toString("hex")
+        );
+      });
+    });
+
+    it("accepts a seed", function () {
+      var seed = Buffer.from(data.seed, "hex");
+      var signatures = ed25519.SignBatch([Buffer.from(data.message)], seed);
+      assert.equal(signatures.toString("hex"), data.signature);
+    });
+  });
+
+  describe("#VerifyBatchAsync()", function () {
+    it("agrees with VerifyBatch across several chunks", function () {
+      var batch = makeBatch(300);
+      batch.signatures[5] = Buffer.from(data.invalidSignature, "hex");
+      batch.messages[290] = Buffer.from("tampered");
+      var expected = ed25519.VerifyBatch(batch.messages, batch.signatures, batch.publicKeys);
+      return ed25519.VerifyBatchAsync(batch.messages, batch.signatures, batch.publicKeys).then(function (result) {
+        assert.strictEqual(result.valid, false);
+        assert.equal(result.bitmap.toString("hex"), expected.bitmap.toString("hex"));
+      });
+    });
+
+    it("accepts an empty batch", function (done) {
+      ed25519.VerifyBatchAsync([], [], [], function (err, result) {
+        assert.ifError(err);
+        assert.strictEqual(result.valid, true);
+        assert.equal(result.bitmap.length, 0);
+        done();
+      });
+    });
+
+    it("reports nothing decided past its deadline", function () {
+      var batch = makeBatch(200);
+      var options = { deadline: Date.now() - 1000 };
+      return ed25519.VerifyBatchAsync(batch.messages, batch.signatures, batch.publicKeys, options).then(function (result) {
+        assert.strictEqual(result.valid, false);
+        assert.strictEqual(result.aborted, true);
+        assert.equal(result.decided.toString("hex"), Buffer.alloc(25).toString("hex"));
+      });
+    });
+
+    it("checks nothing once its signal has aborted", function () {
+      var batch = makeBatch(200);
+      var controller = new AbortController();
+      controller.abort();
+      var options = { signal: controller.signal, deadline: new Date(Date.now() + 60000) };
+      return ed25519.VerifyBatchAsync(batch.messages, batch.signatures, batch.publicKeys, options).then(function (result) {
+        assert.strictEqual(result.aborted, true);
+        assert.equal(result.bitmap.toString("hex"), Buffer.alloc(25).toString("hex"));
+        assert.equal(result.decided.toString("hex"), Buffer.alloc(25).toString("hex"));
+      });
+    });
+
+    // Enough 1024-item chunks to keep every pool thread busy for several
+    // rounds, so a job stopped half way through has finished some chunks
+    // and skipped others. Every 100th signature is bad.
+    function runStoppedHalfWay(options) {
+      var base = makeBatch(200);
+      var batch = { messages: [], signatures: [], publicKeys: [] };
+      var count = 8 * 1024 * os.cpus().length;
+      base.signatures[50] = Buffer.from(data.invalidSignature, "hex");
+      base.messages[150] = Buffer.from("tampered");
+      for (var i = 0; i < count; i++) {
+        batch.messages.push(base.messages[i % 200]);
+        batch.signatures.push(base.signatures[i % 200]);
+        batch.publicKeys.push(base.publicKeys[i % 200]);
+      }
+      var started = Date.now();
+      return ed25519.VerifyBatchAsync(batch.messages, batch.signatures, batch.publicKeys).then(function (full) {
+        var half = (Date.now() - started) / 2;
+        return ed25519.VerifyBatchAsync(batch.messages, batch.signatures, batch.publicKeys, options(half)).then(function (result) {
+          var checked = 0;
+          assert.strictEqual(result.valid, false);
+          assert.strictEqual(result.aborted, true);
+          for (var i = 0; i < count; i++) {
+            var bit = (result.bitmap[i >> 3] >> (i & 7)) & 1;
+            if ((result.decided[i >> 3] >> (i & 7)) & 1) {
+              assert.equal(bit, (full.bitmap[i >> 3] >> (i & 7)) & 1);
+              checked++;
+            } else {
+              assert.equal(bit, 0);
+            }
+          }
+          assert.ok(checked > 0 && checked < count, checked + " of " + count + " checked");
+        });
+      });
+    }
+
+    it("reports the items it checked before its signal aborted", function () {
+      return runStoppedHalfWay(function (half) {
+        var controller = new AbortController();
+        setTimeout(function () {
+          controller.abort();
+        }, half);
+        return { signal: controller.signal };
+      });
+    });
+
+    it("reports the items it checked before its deadline", function () {
+      return runStoppedHalfWay(function (half) {
+        return { deadline: Date.now() + half };
+      });
+    });
+
+    it("passes on errors thrown while reading its options", function () {
+      var batch = makeBatch(20);
+      var options = {};
+      Object.defineProperty(options, "deadline", { get: function () { throw new Error("no deadline"); } });
+      return ed25519.VerifyBatchAsync(batch.messages, batch.signatures, batch.publicKeys, options).then(function () {
+        assert.fail("read a deadline that throws");
+      }, function (err) {
+        assert.equal(err.message, "no deadline");
+      });
+    });
+  });
+
+  describe("#SignBatchAsync()", function () {
+    it("returns the same signatures as SignBatch", function () {
+      var seed = Buffer.from(data.seed, "hex");
+      var messages = [];
+      for (var i = 0; i < 150; i++) {
+        messages.push(crypto.randomBytes(i));
+      }
+      return ed25519.SignBatchAsync(messages, seed).then(function (signatures) {
+        assert.equal(signatures.toString("hex"), ed25519.SignBatch(messages, seed).toString("hex"));
+      });
+    });
+
+    it("fails once its signal has aborted", function () {
+      var controller = new AbortController();
+      controller.abort();
+      var messages = [Buffer.from(data.message)];
+      return ed25519.SignBatchAsync(messages, Buffer.from(data.seed, "hex"), { signal: controller.signal }).then(function () {
+        assert.fail("expected an error");
+      }, function (err) {
+        assert.equal(err.message, "The operation was aborted");
+      });
+    });
+  });
+
+  describe("#MakeKeypairBatch()", function () {
+    it("gives the same keys as MakeKeypair", function () {
+      var seeds = Buffer.concat([Buffer.from(data.seed, "hex"), crypto.randomBytes(32 * 130)]);
+      var result = ed25519.MakeKeypairBatch(seeds);
+      assert.equal(result.publicKeys.slice(0, 32).toString("hex"), data.publicKey);
+      for (var i = 0; i < 131; i++) {
+        var keyPair = ed25519.MakeKeypair(seeds.slice(32 * i, 32 * (i + 1)));
+        assert.equal(result.publicKeys.slice(32 * i, 32 * (i + 1)).toString("hex"), keyPair.publicKey.toString("hex"));
+        assert.equal(result.privateKeys.slice(64 * i, 64 * (i + 1)).toString("hex"), keyPair.privateKey.toString("hex"));
+      }
+    });
+
+    it("rejects a partial seed", function () {
+      assert.throws(function () {
+        ed25519.MakeKeypairBatch(Buffer.alloc(33));
+      });
+    });
+  });
+
+  describe("#MakeKeypairBatchAsync()", function () {
+    it("derives one keypair per seed", function () {
+      var seeds = crypto.randomBytes(32 * 70);
+      return ed25519.MakeKeypairBatchAsync(seeds).then(function (result) {
+        for (var i = 0; i < 70; i++) {
+          var keyPair = ed25519.MakeKeypair(seeds.slice(32 * i, 32 * (i + 1)));
+          assert.equal(result.publicKeys.slice(32 * i, 32 * (i + 1)).toString("hex"), keyPair.publicKey.toString("hex"));
+          assert.equal(result.privateKeys.slice(64 * i, 64 * (i + 1)).toString("hex"), keyPair.privateKey.toString("hex"));
+        }
+      });
+    });
+
+    it("fails when its signal aborts after the job is queued", function () {
+      var controller = new AbortController();
+      var seeds = crypto.randomBytes(32 * 8 * 1024 * os.cpus().length);
+      var promise = ed25519.MakeKeypairBatchAsync(seeds, { signal: controller.signal });
+      controller.abort();
+      return promise.then(function () {
+        assert.fail("expected an error");
+      }, function (err) {
+        assert.equal(err.message, "The operation was aborted");
+      });
+    });
+
+    it("fails past its deadline", function () {
+      var seeds = crypto.randomBytes(32 * 70);
+      return ed25519.MakeKeypairBatchAsync(seeds, { deadline: Date.now() - 1000 }).then(function () {
+        assert.fail("expected an error");
+      }, function (err) {
+        assert.equal(err.message, "The operation was aborted");
+      });
+    });
+
+    it("throws once the pool is running", function () {
+      return ed25519.MakeKeypairBatchAsync(crypto.randomBytes(32)).then(function () {
+        assert.throws(function () {
+          ed25519.ConfigurePool({ threads: 2 });
+        });
+      });
+    });
+  });
+
+  describe("#MakeKeypairInto()", function () {
+    it("writes the keys into the given Buffers", function () {
+      var publicKey = Buffer.alloc(32);
+      var privateKey = Buffer.alloc(64);
+      ed25519.MakeKeypairInto(Buffer.from(data.seed, "hex"), publicKey, privateKey);
+      assert.equal(publicKey.toString("hex"), data.publicKey);
+      assert.equal(privateKey.toString("hex"), data.privateKey);
+    });
+
+    it("rejects Buffers of the wrong size", function () {
+      assert.throws(function () {
+        ed25519.MakeKeypairInto(Buffer.from(data.seed, "hex"), Buffer.alloc(32), Buffer.alloc(32));
+      });
+    });
+  });
+
+  describe("#SignInto()", function () {
+    it("writes the signature at the offset", function () {
+      var frame = Buffer.alloc(100, 0xaa);
+      ed25519.SignInto(Buffer.from(data.message), Buffer.from(data.seed, "hex"), frame, 10);
+      assert.equal(frame.slice(10, 74).toString("hex"), data.signature);
+      assert.equal(frame[9], 0xaa);
+      assert.equal(frame[74], 0xaa);
+    });
+
+    it("may sign a message it overwrites", function () {
+      var privateKey = Buffer.from(data.privateKey, "hex");
+      var frame = crypto.randomBytes(64);
+      var expected = ed25519.Sign(frame, privateKey);
+      ed25519.SignInto(frame, privateKey, frame);
+      assert.equal(frame.toString("hex"), expected.toString("hex"));
+    });
+
+    it("rejects an offset past the end", function () {
+      assert.throws(function () {
+        ed25519.SignInto(Buffer.from(data.message), Buffer.from(data.seed, "hex"), Buffer.alloc(64), 1);
+      }, RangeError);
+    });
+  });
+
+  describe("SigningKey", function () {
+    it("signs like Sign from a seed, private key or keyPair", function () {
+      var seed = Buffer.from(data.seed, "hex");
+      var keys = [
+        new ed25519.SigningKey(seed),
+        new ed25519.SigningKey(Buffer.from(data.privateKey, "hex")),
+        new ed25519.SigningKey(ed25519.MakeKeypair(seed))
+      ];
+      keys.forEach(function (key) {
+        assert.equal(key.publicKey.toString("hex"), data.publicKey);
+        assert.equal(key.sign(Buffer.from(data.message)).toString("hex"), data.signature);
+      });
+    });
+
+    it("can sign many messages", function () {
+      var privateKey = Buffer.from(data.privateKey, "hex");
+      var key = new ed25519.SigningKey(privateKey);
+      for (var i = 0; i < 8; i++) {
+        var message = crypto.randomBytes(i * 50);
+        assert.equal(key.sign(message).toString("hex"), ed25519.Sign(message, privateKey).toString("hex"));
+      }
+    });
+
+    it("rejects invalid keys", function () {
+      assert.throws(function () {
+        new ed25519.SigningKey(Buffer.alloc(16));
+      });
+    });
+  });
+
+  describe("VerifyingKey", function () {
+    it("verifies like Verify", function () {
+      var key = new ed25519.VerifyingKey(Buffer.from(data.publicKey, "hex"));
+      var message = Buffer.from(data.message);
+      assert.equal(key.publicKey.toString("hex"), data.publicKey);
+      assert.equal(key.verify(message, Buffer.from(data.signature, "hex")), true);
+      assert.equal(key.verify(message, Buffer.from(data.invalidSignature, "hex")), false);
+      assert.equal(key.verify(Buffer.from("tesT"), Buffer.from(data.signature, "hex")), false);
+    });
+
+    it("can verify many messages", function () {
+      var privateKey = Buffer.from(data.privateKey, "hex");
+      var key = new ed25519.VerifyingKey(privateKey.slice(32));
+      for (var i = 0; i < 8; i++) {
+        var message = crypto.randomBytes(i * 50);
+        var signature = ed25519.Sign(message, privateKey);
+        assert.equal(key.verify(message, signature), true);
+        signature[i] ^= 1;
+        assert.equal(key.verify(message, signature), false);
+      }
+    });
+
+    it("rejects invalid public keys", function () {
+      var publicKey = Buffer.alloc(32);
+      publicKey[0] = 2;
+      assert.throws(function () {
+        new ed25519.VerifyingKey(publicKey);
+      });
+      assert.throws(function () {
+        new ed25519.VerifyingKey(Buffer.alloc(31));
+      });
+    });
+  });
+
+  describe("#SetVerifyCacheSize()", function () {
+    afterEach(function () {
+      ed25519.SetVerifyCacheSize(0);
+    });
+
+    it("caches decoded keys for Verify", function () {
+      var message = Buffer.from(data.message);
+      var signature = Buffer.from(data.signature, "hex");
+      var publicKey = Buffer.from(data.publicKey, "hex");
+      ed25519.SetVerifyCacheSize(2);
+      var before = ed25519.GetVerifyCacheStats();
+      for (var i = 0; i < 3; i++) {
+        assert.equal(ed25519.Verify(message, signature, publicKey), true);
+        assert.equal(ed25519.Verify(message, Buffer.from(data.invalidSignature, "hex"), publicKey), false);
+      }
+      var stats = ed25519.GetVerifyCacheStats();
+      assert.equal(stats.capacity, 2);
+      assert.equal(stats.size, 1);
+      assert.equal(stats.misses - before.misses, 1);
+      assert.equal(stats.hits - before.hits, 5);
+    });
+
+    it("remembers invalid keys and evicts the least recently used", function () {
+      var invalidKey = Buffer.alloc(32);
+      invalidKey[0] = 2;
+      var signature = Buffer.from(data.signature, "hex");
+      ed25519.SetVerifyCacheSize(2);
+      assert.equal(ed25519.Verify(Buffer.from(data.message), signature, invalidKey), false);
+      var before = ed25519.GetVerifyCacheStats();
+      assert.equal(ed25519.Verify(Buffer.from(data.message), signature, invalidKey), false);
+      var after = ed25519.GetVerifyCacheStats();
+      assert.equal(after.hits, before.hits + 1);
+      assert.equal(after.misses, before.misses);
+      for (var i = 0; i < 4; i++) {
+        ed25519.Verify(Buffer.from(data.message), signature, ed25519.MakeKeypair(crypto.randomBytes(32)).publicKey);
+      }
+      assert.equal(ed25519.GetVerifyCacheStats().size, 2);
+      ed25519.SetVerifyCacheSize(0);
+      assert.equal(ed25519.GetVerifyCacheStats().size, 0);
+    });
+
+    it("is used by VerifyAsync", function () {
+      ed25519.SetVerifyCacheSize(4);
+      var before = ed25519.GetVerifyCacheStats();
+      var args = [Buffer.from(data.message), Buffer.from(data.signature, "hex"), Buffer.from(data.publicKey, "hex")];
+      return ed25519.VerifyAsync.apply(null, args).then(function (valid) {
+        assert.equal(valid, true);
+        return ed25519.VerifyAsync.apply(null, args);
+      }).then(function (valid) {
+        assert.equal(valid, true);
+        var stats = ed25519.GetVerifyCacheStats();
+        assert.equal(stats.hits + stats.misses - before.hits - before.misses, 2);
+      });
+    });
+  });
+
+  describe("#CreateVerifier()", function () {
+    it("verifies a message given in chunks", function () {
+      var privateKey = Buffer.from(data.privateKey, "hex");
+      var message = crypto.randomBytes(100000);
+      var signature = ed25519.Sign(message, privateKey);
+      var verifier = ed25519.CreateVerifier(signature, privateKey.slice(32));
+      for (var i = 0; i < message.length; i += 7919) {
+        verifier.update(message.slice(i, i + 7919));
+      }
+      assert.equal(verifier.final(), true);
+
+      verifier = ed25519.CreateVerifier(signature, privateKey.slice(32));
+      verifier.update(message.slice(0, 5000)).update(message.slice(5001));
+      assert.equal(verifier.final(), false);
+    });
+
+    it("rejects an invalid signature or key", function () {
+      var verifier = ed25519.CreateVerifier(Buffer.from(data.invalidSignature, "hex"), Buffer.from(data.publicKey, "hex"));
+      assert.equal(verifier.update(Buffer.from(data.message)).final(), false);
+
+      var publicKey = Buffer.alloc(32);
+      publicKey[0] = 2;
+      verifier = ed25519.CreateVerifier(Buffer.from(data.signature, "hex"), publicKey);
+      assert.equal(verifier.update(Buffer.from(data.message)).final(), false);
+    });
+
+    it("can only be finished once", function () {
+      var verifier = ed25519.CreateVerifier(Buffer.from(data.signature, "hex"), Buffer.from(data.publicKey, "hex"));
+      assert.equal(verifier.update(Buffer.from(data.message)).final(), true);
+      assert.throws(function () {
+        verifier.update(Buffer.from(data.message));
+      });
+      assert.throws(function () {
+        verifier.final();
+      });
+    });
+  });
+
+  describe("#SignStream()", function () {
+    var privateKey = Buffer.from(data.privateKey, "hex");
+    var message = crypto.randomBytes(300000);
+
+    function chunks(buffer) {
+      var list = [];
+      for (var i = 0; i < buffer.length; i += 65536) {
+        list.push(buffer.slice(i, i + 65536));
+      }
+      return list;
+    }
+
+    it("signs a message read twice from a stream factory", function () {
+      return ed25519.SignStream(function () {
+        return stream.Readable.from(chunks(message));
+      }, privateKey).then(function (signature) {
+        assert.equal(signature.toString("hex"), ed25519.Sign(message, privateKey).toString("hex"));
+      });
+    });
+
+    it("signs a file descriptor", function (done) {
+      var file = path.join(os.tmpdir(), "ed25519-signstream-" + process.pid);
+      fs.writeFileSync(file, message);
+      var fd = fs.openSync(file, "r");
+      ed25519.SignStream(fd, Buffer.from(data.seed, "hex"), function (err, signature) {
+        fs.closeSync(fd);
+        fs.unlinkSync(file);
+        assert.ifError(err);
+        assert.equal(signature.toString("hex"), ed25519.Sign(message, privateKey).toString("hex"));
+        done();
+      });
+    });
+
+    it("refuses to sign if the source changes between passes", function () {
+      var reads = 0;
+      return ed25519.SignStream(function () {
+        var copy = Buffer.from(message);
+        copy[reads++] ^= 1;
+        return stream.Readable.from(chunks(copy));
+      }, privateKey).then(function () {
+        assert.fail("signed a changing message");
+      }, function (err) {
+        assert.ok(/changed/.test(err.message));
+      });
+    });
+
+    it("can be driven by hand", function () {
+      var signer = ed25519.CreateSigner(privateKey);
+      signer.update(message.slice(0, 1000)).update(message.slice(1000));
+      assert.throws(function () {
+        signer.final();
+      });
+      signer.rewind();
+      signer.update(message);
+      assert.equal(signer.final().toString("hex"), ed25519.Sign(message, privateKey).toString("hex"));
+    });
+  });
+
+  describe("#SignFile() and #VerifyFile()", function () {
+    var privateKey = Buffer.from(data.privateKey, "hex");
+    var publicKey = Buffer.from(data.publicKey, "hex");
+    var file = path.join(os.tmpdir(), "ed25519-signfile-" + process.pid);
+
+    afterEach(function () {
+      if (fs.existsSync(file)) {
+        fs.unlinkSync(file);
+      }
+    });
+
+    it("signs and verifies a file", function () {
+      var message = crypto.randomBytes(200000);
+      var signature;
+      fs.writeFileSync(file, message);
+      return ed25519.SignFile(file, privateKey).then(function (result) {
+        signature = result;
+        assert.equal(signature.toString("hex"), ed25519.Sign(message, privateKey).toString("hex"));
+        return ed25519.VerifyFile(file, signature, publicKey);
+      }).then(function (valid) {
+        assert.equal(valid, true);
+        message[1000] ^= 1;
+        fs.writeFileSync(file, message);
+        return ed25519.VerifyFile(file, signature, publicKey);
+      }).then(function (valid) {
+        assert.equal(valid, false);
+      });
+    });
+
+    it("handles empty files", function (done) {
+      fs.writeFileSync(file, "");
+      ed25519.SignFile(file, Buffer.from(data.seed, "hex"), function (err, signature) {
+        assert.ifError(err);
+        assert.equal(signature.toString("hex"), ed25519.Sign(Buffer.alloc(0), privateKey).toString("hex"));
+        done();
+      });
+    });
+
+    it("reads files that report a size of 0, like those in /proc", function () {
+      if (!fs.existsSync("/proc/version")) {
+        this.skip();
+      }
+      return ed25519.SignFile("/proc/version", privateKey).then(function (signature) {
+        assert.equal(signature.toString("hex"), ed25519.Sign(fs.readFileSync("/proc/version"), privateKey).toString("hex"));
+      });
+    });
+
+    it("reports missing files", function () {
+      return ed25519.VerifyFile(file, Buffer.from(data.signature, "hex"), publicKey).then(function () {
+        assert.fail("verified a missing file");
+      }, function (err) {
+        assert.ok(/ENOENT/.test(err.message));
+      });
+    });
+  });
+
+  describe("#GetBackend()", function () {
+    it("reports the active backend and its kernels", function () {
+      var backend = ed25519.GetBackend();
+      assert.ok(backend.available.indexOf(backend.name) >= 0);
+      assert.ok(["ref10", "fe51", "fe64"].indexOf(backend.field) >= 0);
+      assert.equal(typeof backend.fieldMul, "string");
+      assert.ok(["avx2", "scalar"].indexOf(backend.baseMulX4) >= 0);
+      assert.ok(["avx2", "scalar"].indexOf(backend.doubleScalarMul) >= 0);
+      assert.ok(["safegcd", "pow"].indexOf(backend.invert) >= 0);
+      assert.equal(typeof backend.sha512, "string");
+    });
+
+    // Every public key is encoded through one field inversion of a Z that
+    // is as good as random, and MakeKeypairBatch inverts the product of
+    // many. The reference inverts by x^(p-2), which is what the pow chain
+    // computes, so this cross-checks safegcd against it too.
+    it("gives the public keys of a reference that inverts by x^(p-2)", function () {
+      var p = (1n << 255n) - 19n;
+      function mod(x) {
+        x %= p;
+        return x < 0n ? x + p : x;
+      }
+      function pow(x, e) {
+        var result = 1n;
+        for (x = mod(x); e > 0n; e >>= 1n) {
+          if (e & 1n) {
+            result = result * x % p;
+          }
+          x = x * x % p;
+        }
+        return result;
+      }
+      var d = mod(-121665n * pow(121666n, p - 2n));
+      var base = [
+        15112221349535400772501151409588531511454012693041857206046113283949847762202n,
+        46316835694926478169428394003475163141307993866256225615783033603165251855960n
+      ];
+      // extended coordinates, RFC 8032 section 5.1.4
+      function add(P, Q) {
+        var a = mod((P[1] - P[0]) * (Q[1] - Q[0]));
+        var b = mod((P[1] + P[0]) * (Q[1] + Q[0]));
+        var c = mod(2n * P[3] * Q[3] * d);
+        var e = mod(2n * P[2] * Q[2]);
+        var f = b - a, g = e - c, h = e + c, k = b + a;
+        return [mod(f * g), mod(h * k), mod(g * h), mod(f * k)];
+      }
+      function publicKey(seed) {
+        var digest = crypto.createHash("sha512").update(seed).digest();
+        var scalar = BigInt("0x" + Buffer.from(digest.slice(0, 32)).reverse().toString("hex"));
+        scalar = (scalar & ((1n << 254n) - 8n)) | (1n << 254n);
+        var R = [0n, 1n, 1n, 0n];
+        var B = [base[0], base[1], 1n, mod(base[0] * base[1])];
+        for (; scalar > 0n; scalar >>= 1n) {
+          if (scalar & 1n) {
+            R = add(R, B);
+          }
+          B = add(B, B);
+        }
+        var zInverse = pow(R[2], p - 2n);
+        var y = mod(R[1] * zInverse) | ((mod(R[0] * zInverse) & 1n) << 255n);
+        return Buffer.from(y.toString(16).padStart(64, "0"), "hex").reverse().toString("hex");
+      }
+      var seeds = crypto.randomBytes(32 * 24);
+      var batch = ed25519.MakeKeypairBatch(seeds);
+      for (var i = 0; i < 24; i++) {
+        var seed = seeds.slice(32 * i, 32 * (i + 1));
+        var expected = publicKey(seed);
+        assert.equal(ed25519.MakeKeypair(seed).publicKey.toString("hex"), expected);
+        assert.equal(batch.publicKeys.slice(32 * i, 32 * (i + 1)).toString("hex"), expected);
+      }
+    });
+
+    it("ignores an ED25519_BACKEND that is not available", function () {
+      var script = "console.log(require(" + JSON.stringify(path.join(__dirname, "..")) + ").GetBackend().name);";
+      var env = Object.assign({}, process.env, { ED25519_BACKEND: "no-such-backend" });
+      var name = childProcess.execFileSync(process.execPath, ["-e", script], { env: env }).toString().trim();
+      assert.equal(name, ed25519.GetBackend().available[0]);
+    });
+
+    it("gives the same results on every backend forced by ED25519_BACKEND", function () {
+      this.timeout(30000);
+      var script = "var ed25519 = require(" + JSON.stringify(path.join(__dirname, "..")) + ");" +
+        "var keyPair = ed25519.MakeKeypair(Buffer.from('" + data.seed + "', 'hex'));" +
+        "var batch = ed25519.SignBatch([Buffer.from('a'), Buffer.from('b'), Buffer.from('c'), Buffer.from('d'), Buffer.from('e')], keyPair.privateKey);" +
+        "console.log(JSON.stringify([ed25519.GetBackend().name, keyPair.publicKey.toString('hex'), " +
+        "ed25519.Sign(Buffer.from('" + data.message + "'), keyPair).toString('hex'), batch.toString('hex'), " +
+        "ed25519.Verify(Buffer.from('" + data.message + "'), Buffer.from('" + data.signature + "', 'hex'), keyPair.publicKey), " +
+        "ed25519.Verify(Buffer.from('" + data.message + "'), Buffer.from('" + data.invalidSignature + "', 'hex'), keyPair.publicKey)]));";
+      var expected = null;
+      ed25519.GetBackend().available.forEach(function (name) {
+        var env = Object.assign({}, process.env, { ED25519_BACKEND: name });
+        var result = JSON.parse(childProcess.execFileSync(process.execPath, ["-e", script], { env: env }).toString());
+        assert.equal(result.shift(), name);
+        assert.equal(result[0], data.publicKey);
+        assert.equal(result[1], data.signature);
+        assert.equal(result[3], true);
+        assert.equal(result[4], false);
+        if (expected === null) {
+          expected = result;
+        }
+        assert.deepEqual(result, expected);
+      });
+    });
+  });
 });